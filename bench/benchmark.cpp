@@ -0,0 +1,456 @@
+/**
+ * Throughput benchmark for the edge detection pipeline
+ *
+ * Times each pipeline stage separately on synthetic images (1-100 MP,
+ * gray/RGB/RGBA) and on the sample_images/ corpus:
+ * 1. load       - decode the image file
+ * 2. grayscale  - Image::toGrayscale() per thread count (color images only)
+ * 3. detect     - EdgeDetector::detectEdges() per operator, thread count and ISA variant
+ * 4. save       - PNG encoding and writing of the edge map
+ *
+ * Every measurement runs warmup iterations first, then repeated timed runs.
+ * Results are printed as JSON (median/p99 ns per pixel and GB/s) so runs can
+ * be diffed to gate upgrades; detect results also report the speedup over,
+ * and bit-exactness against, the scalar reference kernels.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "../include/Image.h"
+#include "../include/EdgeDetector.h"
+#include "../include/GradientKernels.h"
+
+// Decoded size limit of Image::loadFromFile for compressed formats
+constexpr size_t DECODE_LIMIT = 100 * 1024 * 1024;
+
+struct BenchConfig {
+    std::vector<double> megapixels = {1, 4, 16, 100};
+    std::vector<int> channels = {1, 3, 4};
+    std::vector<EdgeOperator> operators = {EdgeOperator::Sobel, EdgeOperator::Prewitt, EdgeOperator::Scharr};
+    std::vector<unsigned> threads = {1};
+    std::vector<std::string> variants;     // Empty = every variant supported by the CPU
+    int warmup = 1;
+    int repeats = 7;
+    double maxSeconds = 2.0;               // Per measurement; at least 3 samples are always taken
+    std::string corpus = "sample_images";  // Empty = skip the real-data corpus
+    PngOptions png;
+    std::string output;                    // Empty = stdout
+};
+
+// One timed stage on one image
+struct BenchResult {
+    std::string image;
+    int width = 0, height = 0, channels = 0;
+    std::string stage;
+    std::string operatorName;              // detect only
+    std::string variant;                   // detect only
+    unsigned threads = 0;                  // grayscale, detect and save only
+    size_t bytes = 0;                      // Pixel bytes read plus written by one run
+    std::vector<double> samples;           // Nanoseconds per run
+    std::string skipped;                   // Reason the stage could not run
+    double speedupVsScalar = 0;            // detect only
+    bool matchesScalar = true;             // detect only
+};
+
+double percentile(std::vector<double> samples, double fraction) {
+    // Nearest-rank percentile
+    std::sort(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>(std::ceil(fraction * samples.size()));
+    return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+// Runs `warmup` untimed iterations, then up to `repeats` timed ones; stops early once
+// the time budget is spent and at least 3 samples exist
+std::vector<double> measure(const BenchConfig& config, const std::function<void()>& run) {
+    for (int i = 0; i < config.warmup; ++i) {
+        run();
+    }
+
+    std::vector<double> samples;
+    double spent = 0;
+    while (static_cast<int>(samples.size()) < config.repeats &&
+           (samples.size() < 3 || spent < config.maxSeconds * 1e9)) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto stop = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        spent += samples.back();
+    }
+    return samples;
+}
+
+// Blocky pattern with noise: flat regions, sharp edges and texture, compressible like a photo
+Image makeSyntheticImage(int width, int height, int channels) {
+    std::vector<uint8_t> data(static_cast<size_t>(width) * height * channels);
+    uint32_t state = 0x12345678u;
+    size_t i = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int base = ((x / 64 + y / 48) % 3) * 80 + 20;
+            for (int c = 0; c < channels; ++c) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                int value = base + c * 15 + static_cast<int>(state % 17) - 8;
+                data[i++] = static_cast<uint8_t>(std::min(255, std::max(0, value)));
+            }
+        }
+    }
+    return Image(std::move(data), width, height, channels);
+}
+
+class Benchmark {
+public:
+    explicit Benchmark(const BenchConfig& config) : config(config) {
+        for (const auto& variant : GradientKernels::available()) {
+            if (config.variants.empty() ||
+                std::find(config.variants.begin(), config.variants.end(), variant.name) != config.variants.end()) {
+                variants.push_back(variant.name);
+            }
+        }
+        if (variants.empty()) {
+            throw std::invalid_argument("None of the requested ISA variants is supported on this CPU");
+        }
+        scratchDir = std::filesystem::temp_directory_path() / ("edge_bench_" + std::to_string(getpid()));
+        std::filesystem::create_directories(scratchDir);
+    }
+
+    ~Benchmark() {
+        std::error_code ec;
+        std::filesystem::remove_all(scratchDir, ec);
+    }
+
+    void runSynthetic() {
+        for (double megapixels : config.megapixels) {
+            // 4:3 frames of the requested pixel count
+            int width = std::max(3, static_cast<int>(std::lround(std::sqrt(megapixels * 1e6 * 4 / 3))));
+            int height = std::max(3, static_cast<int>(std::lround(megapixels * 1e6 / width)));
+            for (int channels : config.channels) {
+                std::ostringstream name;
+                name << "synthetic_" << megapixels << "mp_" << channels << "ch";
+                std::cerr << "Benchmarking " << name.str() << " (" << width << "x" << height << ")" << std::endl;
+
+                Image image = makeSyntheticImage(width, height, channels);
+                std::string sourcePath;
+                if (image.getDataSize() <= DECODE_LIMIT) {
+                    PngOptions fast;
+                    fast.compressionLevel = 1;
+                    sourcePath = (scratchDir / (name.str() + ".png")).string();
+                    image.saveToFile(sourcePath, fast);
+                }
+                runImage(name.str(), sourcePath, image);
+                if (!sourcePath.empty()) {
+                    std::filesystem::remove(sourcePath);
+                }
+            }
+        }
+    }
+
+    void runCorpus() {
+        if (config.corpus.empty()) {
+            return;
+        }
+        if (!std::filesystem::is_directory(config.corpus)) {
+            std::cerr << "Corpus directory not found, skipping: " << config.corpus << std::endl;
+            return;
+        }
+
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator(config.corpus)) {
+            if (entry.is_regular_file()) {
+                files.push_back(entry.path());
+            }
+        }
+        std::sort(files.begin(), files.end());
+
+        for (const auto& file : files) {
+            std::cerr << "Benchmarking " << file.string() << std::endl;
+            try {
+                runImage(file.filename().string(), file.string(), Image::loadFromFile(file.string()));
+            } catch (const std::exception& e) {
+                std::cerr << "  Skipped: " << e.what() << std::endl;
+            }
+        }
+    }
+
+    void writeJson(std::ostream& out) const {
+        out << "{\n  \"benchmark\": \"edge_detector\",\n";
+        out << "  \"system\": {\"hardware_threads\": " << std::thread::hardware_concurrency()
+            << ", \"default_variant\": \"" << defaultVariant << "\", \"variants\": [";
+        for (size_t i = 0; i < variants.size(); ++i) {
+            out << (i ? ", " : "") << "\"" << variants[i] << "\"";
+        }
+        out << "]},\n";
+        out << "  \"config\": {\"warmup\": " << config.warmup << ", \"repeats\": " << config.repeats
+            << ", \"max_seconds\": " << config.maxSeconds << ", \"png_level\": " << config.png.compressionLevel
+            << "},\n";
+        out << "  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            out << (i ? ",\n" : "\n") << "    ";
+            writeResult(out, results[i]);
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    const BenchConfig& config;
+    std::vector<std::string> variants;
+    std::string defaultVariant = GradientKernels::active().name;
+    std::filesystem::path scratchDir;
+    std::vector<BenchResult> results;
+
+    BenchResult makeResult(const std::string& name, const Image& image, const std::string& stage) const {
+        BenchResult result;
+        result.image = name;
+        result.width = image.getWidth();
+        result.height = image.getHeight();
+        result.channels = image.getChannels();
+        result.stage = stage;
+        return result;
+    }
+
+    void runImage(const std::string& name, const std::string& sourcePath, const Image& image) {
+        size_t pixels = static_cast<size_t>(image.getWidth()) * image.getHeight();
+
+        BenchResult load = makeResult(name, image, "load");
+        load.bytes = image.getDataSize();
+        if (sourcePath.empty()) {
+            load.skipped = "decoded size exceeds the 100MB load limit";
+        } else {
+            load.samples = measure(config, [&] { Image::loadFromFile(sourcePath); });
+        }
+        results.push_back(load);
+
+        if (image.getChannels() == 3 || image.getChannels() == 4) {
+            for (unsigned threads : config.threads) {
+                BenchResult grayscale = makeResult(name, image, "grayscale");
+                grayscale.threads = threads;
+                grayscale.bytes = image.getDataSize() + pixels;
+                grayscale.samples = measure(config, [&] { image.toGrayscale(LumaWeights::BT601, threads); });
+                results.push_back(grayscale);
+            }
+        }
+
+        for (EdgeOperator op : config.operators) {
+            for (unsigned threads : config.threads) {
+                runDetect(name, image, op, threads);
+            }
+        }
+        GradientKernels::select(defaultVariant);
+
+        Image edges = EdgeDetector::detectEdges(image.view(), config.operators.front());
+        std::string edgesPath = (scratchDir / "edges.png").string();
+        for (unsigned threads : config.threads) {
+            BenchResult save = makeResult(name, image, "save");
+            save.threads = threads;
+            save.bytes = pixels;
+            PngOptions png = config.png;
+            png.threads = threads;
+            save.samples = measure(config, [&] { edges.saveToFile(edgesPath, png); });
+            results.push_back(save);
+        }
+        std::filesystem::remove(edgesPath);
+    }
+
+    void runDetect(const std::string& name, const Image& image, EdgeOperator op, unsigned threads) {
+        EdgeDetectionOptions options;
+        options.threads = threads;
+        size_t pixels = static_cast<size_t>(image.getWidth()) * image.getHeight();
+
+        GradientKernels::select("scalar");
+        Image reference = EdgeDetector::detectEdges(image.view(), op, options);
+
+        double scalarMedian = 0;
+        for (const auto& variant : variants) {
+            GradientKernels::select(variant);
+            BenchResult detect = makeResult(name, image, "detect");
+            detect.operatorName = operatorName(op);
+            detect.variant = variant;
+            detect.threads = threads;
+            detect.bytes = image.getDataSize() + pixels;
+            detect.matchesScalar = EdgeDetector::detectEdges(image.view(), op, options).getData() == reference.getData();
+            detect.samples = measure(config, [&] { EdgeDetector::detectEdges(image.view(), op, options); });
+
+            double median = percentile(detect.samples, 0.5);
+            if (variant == "scalar") {
+                scalarMedian = median;
+            }
+            detect.speedupVsScalar = scalarMedian > 0 ? scalarMedian / median : 0;
+            results.push_back(detect);
+        }
+    }
+
+    static const char* operatorName(EdgeOperator op) {
+        switch (op) {
+        case EdgeOperator::Prewitt: return PrewittOperator::name;
+        case EdgeOperator::Scharr: return ScharrOperator::name;
+        default: return SobelOperator::name;
+        }
+    }
+
+    static void writeResult(std::ostream& out, const BenchResult& result) {
+        out << "{\"image\": \"" << result.image << "\", \"width\": " << result.width
+            << ", \"height\": " << result.height << ", \"channels\": " << result.channels
+            << ", \"stage\": \"" << result.stage << "\"";
+        if (!result.operatorName.empty()) {
+            out << ", \"operator\": \"" << result.operatorName << "\", \"variant\": \"" << result.variant << "\"";
+        }
+        if (result.threads) {
+            out << ", \"threads\": " << result.threads;
+        }
+        if (!result.skipped.empty()) {
+            out << ", \"skipped\": \"" << result.skipped << "\"}";
+            return;
+        }
+
+        double pixels = static_cast<double>(result.width) * result.height;
+        double median = percentile(result.samples, 0.5);
+        double p99 = percentile(result.samples, 0.99);
+        out << ", \"samples\": " << result.samples.size()
+            << ", \"median_ns\": " << static_cast<long long>(median)
+            << ", \"p99_ns\": " << static_cast<long long>(p99)
+            << ", \"median_ns_per_pixel\": " << median / pixels
+            << ", \"p99_ns_per_pixel\": " << p99 / pixels
+            << ", \"gb_per_s\": " << result.bytes / median;    // bytes per ns = GB/s
+        if (!result.operatorName.empty()) {
+            out << ", \"speedup_vs_scalar\": " << result.speedupVsScalar
+                << ", \"matches_scalar\": " << (result.matchesScalar ? "true" : "false");
+        }
+        out << "}";
+    }
+};
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --sizes <list>       Synthetic image sizes in megapixels (default 1,4,16,100; empty = none)" << std::endl;
+    std::cout << "  --channels <list>    Synthetic channel counts (default 1,3,4)" << std::endl;
+    std::cout << "  --operators <list>   Operators to time (default Sobel,Prewitt,Scharr)" << std::endl;
+    std::cout << "  --threads <list>     Thread counts for detect and save (default 1, 0 = all cores)" << std::endl;
+    std::cout << "  --variants <list>    ISA variants for detect (default: all supported)" << std::endl;
+    std::cout << "  --warmup <n>         Untimed runs per measurement (default 1)" << std::endl;
+    std::cout << "  --repeats <n>        Timed runs per measurement (default 7)" << std::endl;
+    std::cout << "  --max-seconds <s>    Time budget per measurement, min. 3 runs (default 2)" << std::endl;
+    std::cout << "  --corpus <dir>       Real-image corpus (default sample_images; empty = none)" << std::endl;
+    std::cout << "  --png-level <0-9>    PNG compression level for the save stage (default 6)" << std::endl;
+    std::cout << "  --output <file>      Write JSON to a file instead of stdout" << std::endl;
+}
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream parser(list);
+    std::string item;
+    while (std::getline(parser, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+template <typename T>
+std::vector<T> parseList(const std::string& option, const std::string& list,
+                         const std::function<T(const std::string&)>& parse) {
+    std::vector<T> values;
+    for (const auto& item : splitList(list)) {
+        try {
+            values.push_back(parse(item));
+        } catch (const std::invalid_argument&) {
+            throw std::invalid_argument("Invalid value for " + option + ": " + item);
+        }
+    }
+    return values;
+}
+
+BenchConfig parseConfig(int argc, char* argv[]) {
+    BenchConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Unknown or incomplete option: " + option);
+        }
+        std::string value = argv[++i];
+
+        if (option == "--sizes") {
+            config.megapixels = parseList<double>(option, value, [](const std::string& s) { return std::stod(s); });
+        } else if (option == "--channels") {
+            config.channels = parseList<int>(option, value, [](const std::string& s) {
+                int channels = std::stoi(s);
+                if (channels != 1 && channels != 3 && channels != 4) {
+                    throw std::invalid_argument(s);
+                }
+                return channels;
+            });
+        } else if (option == "--operators") {
+            config.operators = parseList<EdgeOperator>(option, value, EdgeDetector::parseOperator);
+        } else if (option == "--threads") {
+            config.threads = parseList<unsigned>(option, value, [](const std::string& s) {
+                return static_cast<unsigned>(std::stoul(s));
+            });
+        } else if (option == "--variants") {
+            config.variants = splitList(value);
+        } else if (option == "--warmup") {
+            config.warmup = std::stoi(value);
+        } else if (option == "--repeats") {
+            config.repeats = std::stoi(value);
+        } else if (option == "--max-seconds") {
+            config.maxSeconds = std::stod(value);
+        } else if (option == "--corpus") {
+            config.corpus = value;
+        } else if (option == "--png-level") {
+            config.png.compressionLevel = std::stoi(value);
+        } else if (option == "--output") {
+            config.output = value;
+        } else {
+            throw std::invalid_argument("Unknown or incomplete option: " + option);
+        }
+    }
+
+    // Thread count 0 means "all cores" for both the detector and the encoder
+    for (unsigned& threads : config.threads) {
+        threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (config.operators.empty() || config.threads.empty() || config.repeats < 1 || config.warmup < 0) {
+        throw std::invalid_argument("At least one operator, thread count and timed repeat is required");
+    }
+    return config;
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        BenchConfig config = parseConfig(argc, argv);
+        Benchmark benchmark(config);
+        benchmark.runSynthetic();
+        benchmark.runCorpus();
+
+        if (config.output.empty()) {
+            benchmark.writeJson(std::cout);
+        } else {
+            std::ofstream file(config.output);
+            benchmark.writeJson(file);
+            if (!file) {
+                throw std::runtime_error("Failed to write " + config.output);
+            }
+            std::cerr << "Results saved to: " << config.output << std::endl;
+        }
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+}
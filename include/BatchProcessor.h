@@ -0,0 +1,61 @@
+#pragma once
+#include "EdgeDetector.h"
+#include "ResultCache.h"
+#include <string>
+#include <vector>
+
+/**
+ * Settings for a batch run
+ */
+struct BatchOptions {
+    std::string operatorName = "Sobel";     // Edge detection operator for every image
+    EdgeDetectionOptions detection;         // Options passed to EdgeDetector::detectEdges
+    LoadOptions load;                       // Options passed to Image::loadFromFile
+    std::string outputDir = "output";       // Directory receiving <name>_<operator>_edges.png
+    PngOptions png;                         // Encoder settings for every output
+    unsigned decodeThreads = 0;             // Image decoding workers (0 = half the cores)
+    unsigned encodeThreads = 0;             // PNG encoding workers (0 = half the cores)
+    size_t queueCapacity = 8;               // Images buffered between consecutive stages
+    ResultCache* cache = nullptr;           // Optional: cached results skip decode, detection and encode
+};
+
+/**
+ * Outcome of a batch run
+ */
+struct BatchResult {
+    size_t succeeded = 0;
+    std::vector<std::string> errors;        // One message per failed input
+    double seconds = 0.0;                   // Wall time of the whole run
+
+    double imagesPerSecond() const { return seconds > 0.0 ? succeeded / seconds : 0.0; }
+};
+
+/**
+ * BatchProcessor runs edge detection over many images in one process.
+ * Decoding, edge detection and PNG encoding run as separate stages joined by
+ * bounded queues, so disk reads, decoding, computation and encoding overlap.
+ */
+class BatchProcessor {
+public:
+    /**
+     * Collects input images from a directory (non-recursive, sorted) or a text
+     * file listing one path per line
+     * @throws runtime_error if the source does not exist or lists no images
+     */
+    static std::vector<std::string> collectInputs(const std::string& source);
+
+    /**
+     * Derives unique output paths: <outputDir>/<stem>_<operator>_edges.png, with a
+     * numeric suffix when several inputs share the same file stem. Suffixes skip names
+     * already taken, including by inputs whose own stem ends in such a suffix
+     */
+    static std::vector<std::string> outputPaths(const std::vector<std::string>& inputs,
+                                                const std::string& operatorName,
+                                                const std::string& outputDir);
+
+    /**
+     * Processes all inputs; failures are recorded per image and do not stop the batch
+     * @throws invalid_argument for an unknown operator (checked before any work starts)
+     */
+    static BatchResult run(const std::vector<std::string>& inputs, const BatchOptions& options);
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+/**
+ * BoundedQueue is a blocking FIFO with a fixed capacity, used to connect pipeline
+ * stages: producers block when the queue is full, which keeps a fast stage from
+ * running ahead of a slow one and buffering unbounded amounts of image data.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {}
+
+    /**
+     * Appends an item, waiting while the queue is full
+     * @return false if the queue was closed (the item is dropped)
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * Removes the oldest item, waiting while the queue is empty
+     * @return false once the queue is closed and drained
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    // Stops accepting items; consumers drain what is left, then pop() returns false
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    const size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * BufferPool recycles pixel buffers between frames.
+ * A buffer handed out by acquire() returns to the pool automatically once the
+ * last reference to it (typically an Image) is gone, so steady-state frame
+ * loops reuse the same storage instead of allocating. Thread-safe.
+ */
+class BufferPool {
+public:
+    /**
+     * Creates an empty pool
+     * @param maxBuffers Buffers kept for reuse; when all are in use, acquire()
+     *                   falls back to an unpooled allocation
+     */
+    explicit BufferPool(size_t maxBuffers = 8);
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * Returns a buffer of at least size bytes (contents unspecified)
+     * Buffers may outlive the pool; they are then simply freed.
+     */
+    std::shared_ptr<uint8_t> acquire(size_t size);
+
+    // Number of buffers currently owned by the pool (in use or free)
+    size_t size() const;
+
+private:
+    size_t maxBuffers;
+    mutable std::mutex mutex;
+    // A buffer is free when the pool holds the only reference to it
+    std::vector<std::shared_ptr<std::vector<uint8_t>>> buffers;
+};
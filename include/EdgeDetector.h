@@ -1,52 +1,418 @@
 #pragma once
 #include "Image.h"
+#include "GradientKernels.h"
 #include <string>
+#include <vector>
+
+class BufferPool;
+class ScanlineReader;
+class ScanlineWriter;
+
+/**
+ * Block size for tiled execution; 0 in a dimension spans the whole region
+ */
+struct TileSize {
+    int width = 0;
+    int height = 0;
+
+    bool tiled() const { return width > 0 || height > 0; }
+};
+
+/**
+ * Execution options for EdgeDetector::detectEdges
+ */
+struct EdgeDetectionOptions {
+    // Threads used to process horizontal bands of the image:
+    // 1 = single-threaded (default), 0 = std::thread::hardware_concurrency()
+    unsigned threads = 1;
+
+    // Norm combining horizontal and vertical gradients (L2 = Euclidean, default)
+    GradientNorm norm = GradientNorm::L2;
+
+    // Coefficients converting RGB/RGBA input to grayscale on the fly
+    LumaWeights luma = LumaWeights::BT601;
+
+    // Cache blocking: process the image in tiles of this size, which are then the unit
+    // of parallel work, instead of full-width bands. Unset (default) keeps bands; see
+    // TileTuning for picking a size per machine. Results do not depend on the tiling
+    TileSize tiles;
+};
+
+/**
+ * Caller-owned destinations of EdgeDetector::detectGradientsInto. Row y of a plane
+ * starts at plane + y * stride, with strides counted in elements of the plane.
+ * Only the magnitude is required; null planes are skipped.
+ */
+struct GradientPlanes {
+    uint8_t* magnitude = nullptr;       // Clamped magnitude, as written by detectEdgesInto
+    size_t magnitudeStride = 0;
+    int16_t* gx = nullptr;              // Signed horizontal gradient
+    int16_t* gy = nullptr;              // Signed vertical gradient (positive = brighter below)
+    size_t gradientStride = 0;          // Shared by gx and gy
+    uint8_t* orientation = nullptr;     // Quantized direction, see GradientKernels::orientationRow
+    size_t orientationStride = 0;
+    int orientationBins = 8;            // 4 (direction mod 180°) or 8 (mod 360°)
+};
 
 /**
- * EdgeDetector implements Sobel and Prewitt edge detection algorithms.
+ * Gradient planes of a whole image returned by EdgeDetector::detectGradients
+ */
+struct GradientField {
+    Image magnitude;                    // Single-channel clamped magnitude
+    std::vector<int16_t> gx;            // width * height signed gradients, row-major
+    std::vector<int16_t> gy;
+    Image orientation;                  // Single-channel orientation bins
+};
+
+/**
+ * Thresholds and execution options for EdgeDetector::detectCanny
+ */
+struct CannyOptions {
+    // Hysteresis thresholds on the L2 Sobel magnitude of the smoothed image (the scale of
+    // detectEdges before clamping to 255): pixels above highThreshold seed edges, pixels
+    // above lowThreshold are kept only when connected to a seed
+    int lowThreshold = 40;
+    int highThreshold = 100;
+
+    // Threads used to process horizontal bands: 1 = single-threaded (default), 0 = all cores
+    unsigned threads = 1;
+
+    // Coefficients converting RGB/RGBA input to grayscale on the fly
+    LumaWeights luma = LumaWeights::BT601;
+};
+
+/**
+ * EdgeDetector implements Sobel, Prewitt and Scharr edge detection algorithms.
  * Uses 3x3 convolution kernels to detect image gradients and calculate edge magnitude.
- * Automatically handles grayscale conversion and boundary padding.
+ * Grayscale conversion and boundary padding are fused into a single pass over the input.
+ * Operators are resolved to a row kernel specialized for their coefficients once per
+ * call: by name, by EdgeOperator, or at compile time from an operator policy type.
  */
 class EdgeDetector {
 public:
+    /**
+     * Scratch memory reused across detectEdgesInto calls.
+     * Buffers grow to fit the largest image and band count seen and are never shrunk,
+     * so repeated calls on same-sized frames do not allocate.
+     * A workspace must not be used by two calls at the same time.
+     */
+    class Workspace {
+    public:
+        // Bytes of scratch memory currently held
+        size_t capacity() const { return rowWindows.size() + gradientRows.size() * sizeof(int16_t); }
+
+    private:
+        friend class EdgeDetector;
+        std::vector<uint8_t> rowWindows;     // Three padded grayscale rows per band or tiling worker
+        std::vector<int16_t> gradientRows;   // One gx and one gy row per band or worker, when not stored
+    };
+
     /**
      * Detects edges in an image using specified operator
      * @param image Input image (any format - automatically converted to grayscale)
-     * @param operatorName "Sobel" or "Prewitt" (case-insensitive)
+     * @param operatorName "Sobel", "Prewitt" or "Scharr" (case-insensitive)
+     * @param options Execution options (e.g. parallel band processing)
      * @return New grayscale Image with detected edges (white=edges, black=no edges)
      * @throws invalid_argument for unknown operators
      * @throws runtime_error for images < 3x3 pixels
      */
-    static Image detectEdges(const Image& image, const std::string& operatorName);
+    static Image detectEdges(const Image& image, const std::string& operatorName,
+                             const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges in pixels owned elsewhere (decoder buffers, mapped files, crops)
+     * without copying them
+     * @param image View of 1/3/4-channel interleaved pixels; rows may be strided
+     * @see detectEdges(const Image&, const std::string&, const EdgeDetectionOptions&)
+     */
+    static Image detectEdges(const ImageView& image, const std::string& operatorName,
+                             const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges into caller-owned memory without allocating in steady state
+     * @param image View of 1/3/4-channel interleaved pixels; rows may be strided
+     * @param output Destination of image.width * image.height magnitudes; row y starts
+     *               at output + y * outputStride (outputStride >= image.width)
+     * @param workspace Scratch buffers reused from previous calls
+     * @throws invalid_argument for unknown operators or a null/too narrow output
+     * @throws runtime_error for images < 3x3 pixels
+     */
+    static void detectEdgesInto(const ImageView& image, const std::string& operatorName,
+                                uint8_t* output, size_t outputStride, Workspace& workspace,
+                                const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges into an Image whose storage comes from a BufferPool; with a
+     * reused workspace and released result Images, steady state does not allocate
+     * @see detectEdgesInto
+     */
+    static Image detectEdges(const ImageView& image, const std::string& operatorName,
+                             Workspace& workspace, BufferPool& pool,
+                             const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges inside regions of interest, reading only the pixels of each
+     * rectangle plus a 1-pixel halo. Halo pixels inside the image are real
+     * neighbours and borders are replicated only at the image edges, so each result
+     * equals the matching crop of the full-frame output at a cost proportional to
+     * the region area.
+     * @param regions Rectangles inside the image; they may overlap
+     * @return One single-channel Image of region.width x region.height per region
+     * @throws invalid_argument for unknown operators or empty/out-of-bounds regions
+     * @throws runtime_error for images < 3x3 pixels
+     */
+    static std::vector<Image> detectEdgesInRegions(const ImageView& image, const std::string& operatorName,
+                                                   const std::vector<Rect>& regions,
+                                                   const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges inside one region into caller-owned memory
+     * @param output Destination of region.width * region.height magnitudes; row y of the
+     *               region starts at output + y * outputStride (outputStride >= region.width)
+     * @see detectEdgesInRegions
+     */
+    static void detectRegionInto(const ImageView& image, EdgeOperator op, const Rect& region, uint8_t* output,
+                                 size_t outputStride, Workspace& workspace, const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Built-in operator overloads of the calls above, without name parsing
+     */
+    static Image detectEdges(const ImageView& image, EdgeOperator op, const EdgeDetectionOptions& options = {});
+    static void detectEdgesInto(const ImageView& image, EdgeOperator op, uint8_t* output, size_t outputStride,
+                                Workspace& workspace, const EdgeDetectionOptions& options = {});
+    static Image detectEdges(const ImageView& image, EdgeOperator op, Workspace& workspace, BufferPool& pool,
+                             const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges with several operators in one pass: grayscale conversion and padding
+     * run once, and each 3x3 neighbourhood is loaded once for all operators, which share
+     * its row and column differences. Each result equals detectEdges with that operator
+     * @param operatorNames Distinct "Sobel", "Prewitt" or "Scharr" names (case-insensitive)
+     * @return One single-channel Image per operator, in the order of operatorNames
+     * @throws invalid_argument for unknown or repeated operators, or an empty list
+     * @throws runtime_error for images < 3x3 pixels
+     */
+    static std::vector<Image> detectEdgesMulti(const ImageView& image, const std::vector<std::string>& operatorNames,
+                                               const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges with several operators in one pass into caller-owned memory
+     * @param ops Distinct built-in operators
+     * @param outputs One destination of image.width * image.height magnitudes per operator,
+     *                in the order of ops; row y starts at outputs[i] + y * outputStride
+     * @param workspace Scratch buffers reused from previous calls
+     * @throws invalid_argument for repeated operators, an empty list or a null/too narrow output
+     * @throws runtime_error for images < 3x3 pixels
+     * @see detectEdgesMulti
+     */
+    static void detectEdgesMultiInto(const ImageView& image, const std::vector<EdgeOperator>& ops,
+                                     uint8_t* const* outputs, size_t outputStride, Workspace& workspace,
+                                     const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges with an operator policy known at compile time (see EdgeOperators.h).
+     * Built-in policies use the SIMD kernels; custom policies get a portable row
+     * kernel with every tap unrolled and zero coefficients removed.
+     */
+    template <typename Operator>
+    static Image detectEdges(const ImageView& image, const EdgeDetectionOptions& options = {}) {
+        return detectWithKernel(image, rowKernel<Operator>(options.norm), options);
+    }
+    
+    template <typename Operator>
+    static void detectEdgesInto(const ImageView& image, uint8_t* output, size_t outputStride,
+                                Workspace& workspace, const EdgeDetectionOptions& options = {}) {
+        detectIntoWithKernel(image, rowKernel<Operator>(options.norm), output, outputStride, workspace, options);
+    }
+    
+    /**
+     * Detects edges and keeps what the kernel computes on the way: the signed gx/gy
+     * gradients and their quantized orientation are written next to the magnitude in
+     * the same pass, while each row is still in cache
+     * @param planes Destinations; magnitude is required, gx, gy and orientation are optional
+     * @param workspace Scratch buffers reused from previous calls
+     * @throws invalid_argument for a null/too narrow plane or orientationBins other than 4 or 8
+     * @throws runtime_error for images < 3x3 pixels
+     */
+    static void detectGradientsInto(const ImageView& image, EdgeOperator op, const GradientPlanes& planes,
+                                    Workspace& workspace, const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Computes magnitude, gx, gy and orientation planes of a whole image in one pass
+     * @param operatorName "Sobel", "Prewitt" or "Scharr" (case-insensitive)
+     * @param orientationBins 4 or 8
+     * @see detectGradientsInto
+     */
+    static GradientField detectGradients(const ImageView& image, const std::string& operatorName,
+                                         int orientationBins = 8, const EdgeDetectionOptions& options = {});
+    
+    /**
+     * Detects edges strip by strip without holding the whole image in memory.
+     * Input rows are read stripRows at a time (plus a 1-row halo on each side)
+     * and output rows are written as soon as they are complete, so memory use
+     * is O(width * stripRows) regardless of image height.
+     * @param reader Source of input scanlines (PGM/PPM/raw, 1/3/4 channels)
+     * @param writer Destination for single-channel output scanlines of the same size
+     * @param stripRows Rows processed per strip (and the unit of band parallelism)
+     * @throws invalid_argument for unknown operators or mismatched writer dimensions
+     * @throws runtime_error for images < 3x3 pixels or I/O failures
+     */
+    static void detectEdgesStreaming(ScanlineReader& reader, ScanlineWriter& writer,
+                                     const std::string& operatorName,
+                                     const EdgeDetectionOptions& options = {}, int stripRows = 64);
+    
+    /**
+     * Canny edge detection: 3x3 Gaussian smoothing, Sobel gradients, non-maximum
+     * suppression and hysteresis. Smoothing is folded into a 5x5 derivative-of-Gaussian
+     * gradient, and suppression uses the int16 gx/gy of the same fused pass, so the input
+     * is read once and only the output image is written.
+     * @param image View of 1/3/4-channel interleaved pixels; rows may be strided
+     * @return Binary single-channel Image: 255 on edges, 0 elsewhere
+     * @throws invalid_argument for negative or inverted thresholds
+     * @throws runtime_error for images < 3x3 pixels
+     */
+    static Image detectCanny(const ImageView& image, const CannyOptions& options = {});
+    
+    /**
+     * Canny edge detection into caller-owned memory
+     * @param output Destination of image.width * image.height pixels; row y starts
+     *               at output + y * outputStride (outputStride >= image.width)
+     * @see detectCanny
+     */
+    static void detectCannyInto(const ImageView& image, uint8_t* output, size_t outputStride,
+                                const CannyOptions& options = {});
+    
+    /**
+     * Resolves an operator name
+     * @param operatorName "Sobel", "Prewitt" or "Scharr" (case-insensitive)
+     * @throws invalid_argument for unknown operators
+     */
+    static EdgeOperator parseOperator(const std::string& operatorName);
+    
+    /**
+     * Checks an operator name without processing an image
+     * @param operatorName "Sobel", "Prewitt" or "Scharr" (case-insensitive)
+     * @throws invalid_argument for unknown operators
+     */
+    static void validateOperator(const std::string& operatorName);
+    
+    /**
+     * Parses a gradient norm name
+     * @param name "L2", "L1" or "Linf" (case-insensitive)
+     * @throws invalid_argument for unknown norms
+     */
+    static GradientNorm parseNorm(const std::string& name);
 
 private:
-    // Sobel operator kernels for gradient calculation
-    static const int SOBEL_X[3][3];   // Horizontal edge detection
-    static const int SOBEL_Y[3][3];   // Vertical edge detection
+    // Row kernel of an operator policy: SIMD for built-ins, unrolled scalar otherwise
+    template <typename Operator>
+    static GradientKernels::RowKernel rowKernel(GradientNorm norm) {
+        if constexpr (EdgeOperatorTraits::isBuiltin<Operator>()) {
+            return GradientKernels::rowKernel(Operator::id, norm);
+        } else {
+            return GradientKernels::unrolledRowKernel<Operator>(norm);
+        }
+    }
+    
+    /**
+     * Validates the image and computes all rows into a new single-channel Image
+     * @throws runtime_error for invalid images
+     */
+    static Image detectWithKernel(const ImageView& image, GradientKernels::RowKernel rowKernel,
+                                  const EdgeDetectionOptions& options);
+    
+    /**
+     * Validates the image and output, then computes all rows into output
+     * @throws runtime_error for invalid images
+     * @throws invalid_argument for a null or too narrow output
+     */
+    static void detectIntoWithKernel(const ImageView& image, GradientKernels::RowKernel rowKernel,
+                                     uint8_t* output, size_t outputStride, Workspace& workspace,
+                                     const EdgeDetectionOptions& options);
+    
+    /**
+     * Checks the minimum size and supported channel counts
+     * @throws runtime_error if the image cannot be processed
+     */
+    static void validateDimensions(int width, int height, int channels);
+    
+    /**
+     * Checks that the input view has data and a stride covering its rows
+     * @throws runtime_error for invalid input data
+     */
+    static void validateInput(const ImageView& image);
     
-    // Prewitt operator kernels for gradient calculation  
-    static const int PREWITT_X[3][3]; // Horizontal edge detection
-    static const int PREWITT_Y[3][3]; // Vertical edge detection
+    /**
+     * Checks the input view and output buffer of detectEdgesInto
+     * @throws runtime_error for invalid input data
+     * @throws invalid_argument for a null or too narrow output
+     */
+    static void validateBuffers(const ImageView& image, const uint8_t* output, size_t outputStride);
+    
+    /**
+     * Checks that a region is non-empty and lies inside the image
+     * @throws invalid_argument otherwise
+     */
+    static void validateRegion(const ImageView& image, const Rect& region);
+    
+    /**
+     * Computes the output pixels of a region of image, split into bands of rows on
+     * the thread pool when options request more than one thread
+     * @param rowKernel Row kernel of the operator and norm
+     * @param output Destination of the region's first row; consecutive rows are outputStride bytes apart
+     * @param workspace Provides the per-band row windows
+     */
+    static void computeRows(const ImageView& image, const Rect& region, GradientKernels::RowKernel rowKernel,
+                            const EdgeDetectionOptions& options, uint8_t* output, size_t outputStride,
+                            Workspace& workspace);
+    
+    /**
+     * Splits a region into bands of rows, or into options.tiles when set, on the thread
+     * pool when options request more than one thread, and sizes the workspace scratch.
+     * Bands are assigned statically; tiles are claimed by workers in row-major order
+     * @param processBand Called as processBand(band, window, gradientRows) with band a Rect
+     * @param gradientScratch Whether bands need gx/gy scratch rows (2 * band.width values)
+     */
+    template <typename BandFunction>
+    static void forEachBand(const ImageView& image, const Rect& region, const EdgeDetectionOptions& options,
+                            Workspace& workspace, bool gradientScratch, BandFunction& processBand);
+    
+    /**
+     * Converts columns [firstColumn, firstColumn + columns) of source row y to grayscale
+     * into paddedRow with 1 halo pixel on each side: the neighbouring pixel inside the
+     * image, replicated border outside it; rows outside the image are clamped to the edge
+     * @param paddedRow Destination of columns + 2 pixels
+     */
+    static void loadPaddedRow(const ImageView& image, int y, int firstColumn, int columns, uint8_t* paddedRow,
+                              LumaWeights luma);
     
     /**
-     * Creates padded image to handle boundary conditions during convolution
-     * Uses border replication to extend image edges
+     * Computes the output pixels of band from interleaved input pixels,
+     * fusing grayscale conversion, border padding and the gradient kernel
+     * @param image Interleaved 1/3/4-channel image data
+     * @param window Scratch of 3 * (band.width + 2) bytes for the rolling row window
+     * @param output Destination of the band's first row; consecutive rows are outputStride bytes apart
+     * @param luma Coefficients for color input
      */
-    static std::vector<uint8_t> createPaddedImage(const std::vector<uint8_t>& originalData,
-                                                  int width, int height, int padSize = 1);
+    static void processRows(const ImageView& image, const Rect& band,
+                            GradientKernels::RowKernel rowKernel,
+                            uint8_t* window, uint8_t* output, size_t outputStride, LumaWeights luma);
     
     /**
-     * Applies 3x3 convolution kernel at specified position
-     * @return Convolution result (gradient component)
+     * processRows for detectEdgesMultiInto: one output row per operator of the kernel's set
+     * @param outputs Destinations of the band's first row, indexed by EdgeOperator
      */
-    static int applyKernel(const std::vector<uint8_t>& imageData, int width, int x, int y, 
-                          const int kernel[3][3]);
+    static void processMultiRows(const ImageView& image, const Rect& band,
+                                 GradientKernels::MultiRowKernel rowKernel, uint8_t* window,
+                                 uint8_t* const* outputs, size_t outputStride, LumaWeights luma);
     
     /**
-     * Calculates edge magnitude from gradient components using Euclidean norm
-     * @param gx Horizontal gradient component
-     * @param gy Vertical gradient component  
-     * @return Edge magnitude clamped to [0, 255]
+     * processRows for detectGradientsInto: also writes the requested gx/gy and
+     * orientation rows of the band
+     * @param planes Destinations of the band's first row
+     * @param gradientRows Scratch of 2 * band.width values used when gx or gy is not stored
      */
-    static uint8_t calculateMagnitude(int gx, int gy);
+    static void processGradientRows(const ImageView& image, const Rect& band,
+                                    GradientKernels::PlaneRowKernel rowKernel, uint8_t* window,
+                                    const GradientPlanes& planes, int16_t* gradientRows, LumaWeights luma);
 };
\ No newline at end of file
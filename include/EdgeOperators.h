@@ -0,0 +1,116 @@
+#pragma once
+#include <type_traits>
+
+/**
+ * Built-in gradient operators, selectable at runtime
+ */
+enum class EdgeOperator {
+    Sobel,    // [1 2 1] smoothing: good noise suppression
+    Prewitt,  // [1 1 1] smoothing: simplest, slightly more noise sensitive
+    Scharr    // [3 10 3] smoothing: best rotational symmetry of the 3x3 operators
+};
+
+/**
+ * Operator policies: each type carries its 3x3 kernels as compile-time constants.
+ * Any type with the same members can be passed to EdgeDetector::detectEdges<Operator>,
+ * which specializes the row kernel on its coefficients (zero taps compile away):
+ *
+ *   struct RobertsCrossOperator {
+ *       static constexpr const char* name = "RobertsCross";
+ *       static constexpr int kernelX[3][3] = {{0, 0, 0}, {0, 1, 0}, {0, 0, -1}};
+ *       static constexpr int kernelY[3][3] = {{0, 0, 0}, {0, 0, 1}, {0, -1, 0}};
+ *   };
+ *
+ * kernelX is applied as a correlation: tap [r][c] weighs the pixel at
+ * (x + c - 1, y + r - 1).
+ */
+struct SobelOperator {
+    static constexpr EdgeOperator id = EdgeOperator::Sobel;
+    static constexpr const char* name = "Sobel";
+    static constexpr int kernelX[3][3] = {
+        {-1, 0, 1},  // Detects vertical edges (horizontal gradient)
+        {-2, 0, 2},  // Central row has double weight
+        {-1, 0, 1}
+    };
+    static constexpr int kernelY[3][3] = {
+        {-1, -2, -1},
+        { 0,  0,  0},
+        { 1,  2,  1}
+    };
+};
+
+struct PrewittOperator {
+    static constexpr EdgeOperator id = EdgeOperator::Prewitt;
+    static constexpr const char* name = "Prewitt";
+    static constexpr int kernelX[3][3] = {
+        {-1, 0, 1},  // Detects vertical edges (horizontal gradient)
+        {-1, 0, 1},  // Equal weights across rows
+        {-1, 0, 1}
+    };
+    static constexpr int kernelY[3][3] = {
+        {-1, -1, -1},
+        { 0,  0,  0},
+        { 1,  1,  1}
+    };
+};
+
+struct ScharrOperator {
+    static constexpr EdgeOperator id = EdgeOperator::Scharr;
+    static constexpr const char* name = "Scharr";
+    static constexpr int kernelX[3][3] = {
+        { -3, 0,  3},
+        {-10, 0, 10},  // Weights chosen for rotation invariance
+        { -3, 0,  3}
+    };
+    static constexpr int kernelY[3][3] = {
+        {-3, -10, -3},
+        { 0,   0,  0},
+        { 3,  10,  3}
+    };
+};
+
+/**
+ * Compile-time properties of operator policies
+ */
+namespace EdgeOperatorTraits {
+
+// Built-in policies carry an EdgeOperator id and have SIMD row kernels
+template <typename Operator, typename = void>
+struct IsBuiltin : std::false_type {};
+
+template <typename Operator>
+struct IsBuiltin<Operator, std::void_t<decltype(Operator::id)>> : std::true_type {};
+
+template <typename Operator>
+constexpr bool isBuiltin() {
+    return IsBuiltin<Operator>::value;
+}
+
+// Sum of absolute kernel weights: bounds |gx| and |gy| at 255 times this value
+template <typename Operator>
+constexpr int absoluteWeight() {
+    int sumX = 0, sumY = 0;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            sumX += Operator::kernelX[r][c] < 0 ? -Operator::kernelX[r][c] : Operator::kernelX[r][c];
+            sumY += Operator::kernelY[r][c] < 0 ? -Operator::kernelY[r][c] : Operator::kernelY[r][c];
+        }
+    }
+    return sumX > sumY ? sumX : sumY;
+}
+
+// Smoothing-times-difference form: kernelX = s^T * [-1 0 1] and kernelY is its
+// transpose, so gx and gy share one smoothing vector s (the right column of kernelX)
+template <typename Operator>
+constexpr bool isSeparable() {
+    for (int r = 0; r < 3; ++r) {
+        int s = Operator::kernelX[r][2];
+        if (Operator::kernelX[r][0] != -s || Operator::kernelX[r][1] != 0 ||
+            Operator::kernelY[0][r] != -s || Operator::kernelY[1][r] != 0 || Operator::kernelY[2][r] != s) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace EdgeOperatorTraits
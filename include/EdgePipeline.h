@@ -0,0 +1,115 @@
+#pragma once
+#include "EdgeDetector.h"
+#include <array>
+#include <vector>
+
+/**
+ * 3x3 smoothing kernels for EdgePipeline::blur
+ */
+enum class BlurKernel {
+    Box,        // Mean of the 3x3 neighbourhood
+    Gaussian    // [1 2 1] x [1 2 1] / 16
+};
+
+/**
+ * Execution options for EdgePipeline::run
+ */
+struct PipelineOptions {
+    // Threads claiming tiles: 1 = single-threaded (default), 0 = all cores
+    unsigned threads = 1;
+
+    // Output block computed by all stages before moving on; 0 in a dimension spans the
+    // whole image. The default keeps every stage's tile in L1/L2 cache
+    TileSize tiles{256, 64};
+};
+
+/**
+ * EdgePipeline describes a chain of stages lazily and runs it fused, tile by tile:
+ *
+ *   Image edges = EdgePipeline()
+ *                     .grayscale(LumaWeights::BT709)
+ *                     .blur(BlurKernel::Gaussian)
+ *                     .gradient(EdgeOperator::Sobel)
+ *                     .threshold(64)
+ *                     .run(view);
+ *
+ * Every stage maps an 8-bit plane to an 8-bit plane. Grayscale conversion always comes
+ * first; neighbourhood stages (blur, gradient) read a 1-pixel halo and pointwise stages
+ * (threshold, normalize) none. For each output tile the input is converted once for the
+ * tile grown by the halos of all later stages, and each neighbourhood stage shrinks that
+ * margin by one pixel. Only two tile-sized buffers per thread are live, so intermediate
+ * planes never travel to memory. Consecutive pointwise stages are folded into one lookup
+ * table, and gradients run on the same SIMD row kernels as EdgeDetector.
+ *
+ * Every stage pads its input by replicating the image border, exactly like running the
+ * stages one after another on whole images: a pipeline of just gradient(op, norm) equals
+ * EdgeDetector::detectEdges. Results do not depend on tiles or threads.
+ */
+class EdgePipeline {
+public:
+    /**
+     * Sets the coefficients converting RGB/RGBA input to grayscale (BT601 by default)
+     * @throws invalid_argument if called after another stage
+     */
+    EdgePipeline& grayscale(LumaWeights luma);
+
+    // Appends a 3x3 smoothing stage; results are rounded to the nearest integer
+    EdgePipeline& blur(BlurKernel kernel);
+
+    // Appends a gradient stage producing the clamped magnitude, as EdgeDetector::detectEdges
+    EdgePipeline& gradient(EdgeOperator op, GradientNorm norm = GradientNorm::L2);
+
+    /**
+     * Appends a binarization stage: 255 where the value is at least level, 0 elsewhere
+     * @throws invalid_argument for levels outside [0, 255]
+     */
+    EdgePipeline& threshold(int level);
+
+    /**
+     * Appends a contrast stretch mapping [low, high] linearly onto [0, 255], clamping
+     * values outside the range
+     * @throws invalid_argument unless 0 <= low < high <= 255
+     */
+    EdgePipeline& normalize(int low, int high);
+
+    /**
+     * Runs all stages on an image
+     * @param image View of 1/3/4-channel interleaved pixels; rows may be strided
+     * @return Single-channel Image of the last stage
+     * @throws runtime_error for empty images, invalid data or unsupported channel counts
+     */
+    Image run(const ImageView& image, const PipelineOptions& options = {}) const;
+
+    /**
+     * Runs all stages into caller-owned memory
+     * @param output Destination of image.width * image.height values; row y starts at
+     *               output + y * outputStride (outputStride >= image.width)
+     * @throws invalid_argument for a null or too narrow output
+     * @see run
+     */
+    void runInto(const ImageView& image, uint8_t* output, size_t outputStride,
+                 const PipelineOptions& options = {}) const;
+
+    // Pixels of input around each output pixel the stages read: one per neighbourhood stage
+    int halo() const;
+
+private:
+    // A neighbourhood stage runs rowKernel on three padded rows; a pointwise stage looks up table
+    struct Stage {
+        GradientKernels::RowKernel rowKernel = nullptr;
+        std::array<uint8_t, 256> table{};
+    };
+
+    // Appends a pointwise stage, folding it into a directly preceding one
+    void appendTable(const std::array<uint8_t, 256>& table);
+
+    /**
+     * Computes one output tile
+     * @param buffers Two scratch planes of (tile.width + 2 * halo()) * (tile.height + 2 * halo()) bytes
+     */
+    void processTile(const ImageView& image, const Rect& tile, uint8_t* buffers[2], uint8_t* output,
+                     size_t outputStride) const;
+
+    LumaWeights luma = LumaWeights::BT601;
+    std::vector<Stage> stages;
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include "BufferPool.h"
+#include "EdgeDetector.h"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Settings for EdgeServer
+ */
+struct ServerOptions {
+    std::string socketPath;                     // Filesystem path of the Unix domain socket
+    unsigned workers = 0;                       // Concurrent connections (0 = hardware_concurrency, at least 2)
+    size_t maxPayloadBytes = 256 * 1024 * 1024; // Largest inline input accepted
+    TileSize tiles;                             // Tiling of every request, e.g. TileTuning::tuned()
+};
+
+/**
+ * EdgeServer is a long-running daemon that serves edge detection requests over a
+ * Unix domain socket, so callers do not pay process startup per image. Worker
+ * threads stay alive with their detection workspaces, result buffers come from a
+ * shared BufferPool, and each worker serves one connection at a time.
+ *
+ * Requests run single-threaded on their connection's worker by default, so up to
+ * `workers` of them run concurrently. A request with threads=0 or threads > 1 runs on
+ * the process-wide pool of hardware_concurrency threads instead; such requests take
+ * turns on that pool. While one waits for the pool, its worker blocks and reads no
+ * further requests from that connection, and single-threaded requests on other
+ * connections keep running.
+ *
+ * Protocol: a client sends one request line, followed by `size` payload bytes when
+ * the input is inline, and reads one response line, followed by `size` payload
+ * bytes when the result is returned inline. Connections may carry any number of
+ * requests. Values are percent-encoded (%20 for a space).
+ *
+ *   detect operator=<Sobel|Prewitt|Scharr|Canny> input=<path|-> output=<path|->
+ *          [size=<bytes>] [raw=WxHxC] [format=png|pgm|raw] [norm=L2|L1|Linf]
+ *          [threads=<n>] [png-level=0-9] [png-filter=<f>] [canny-low=<t>] [canny-high=<t>]
+ *   ping
+ *
+ *   ok width=<w> height=<h> decode_us=<t> detect_us=<t> encode_us=<t> total_us=<t> size=<bytes>
+ *   error <message>
+ *
+ * input=- takes an encoded image payload (PNG, JPEG, PGM/PPM, ...), or raw pixels
+ * when raw=WxHxC is given; raw and PGM/PPM payloads are processed in place without
+ * copying, other formats are decoded from memory. output=- returns the result in
+ * `format` (default png); an output path is written like Image::saveToFile.
+ */
+class EdgeServer {
+public:
+    /**
+     * Binds and listens on options.socketPath, replacing a stale socket file
+     * @throws runtime_error if the socket cannot be created or bound
+     */
+    explicit EdgeServer(const ServerOptions& options);
+    ~EdgeServer();
+
+    EdgeServer(const EdgeServer&) = delete;
+    EdgeServer& operator=(const EdgeServer&) = delete;
+
+    /**
+     * Serves connections until stop() is called; returns after all workers exited.
+     * Transient accept errors such as running out of file descriptors are retried
+     * @throws system_error if worker threads cannot be started; started ones are stopped
+     */
+    void run();
+
+    /**
+     * Stops accepting connections and closes open ones; safe to call from any thread
+     */
+    void stop();
+
+    const std::string& socketPath() const { return options.socketPath; }
+
+private:
+    void workerLoop();
+    void serveConnection(int connection);
+
+    ServerOptions options;
+    int listener = -1;
+    std::atomic<bool> stopping{false};
+    BufferPool resultBuffers;
+
+    std::mutex connectionsMutex;        // Guards connections
+    std::set<int> connections;          // Open client sockets, closed by stop()
+};
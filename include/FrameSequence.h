@@ -0,0 +1,91 @@
+#pragma once
+#include "EdgeDetector.h"
+#include <string>
+#include <vector>
+
+/**
+ * Settings for FrameSequence
+ */
+struct SequenceOptions {
+    // Edge detection settings; threads also split the frame diff and the tile updates
+    EdgeDetectionOptions detection;
+
+    // Side of the square tiles frames are compared and recomputed in (at least 2)
+    int tileSize = 64;
+};
+
+/**
+ * Result of FrameSequence::process
+ */
+struct FrameUpdate {
+    ImageView edges{};          // Edge map of the frame, valid until the next process() call
+    size_t dirtyTiles = 0;      // Tiles whose input changed and were recomputed
+    size_t totalTiles = 0;
+    bool fullFrame = false;     // Whole frame computed (first frame or new geometry)
+};
+
+/**
+ * FrameSequence detects edges in consecutive frames of a stream, such as a fixed
+ * camera feed, recomputing only what changed. It keeps a copy of the previous input
+ * and the previous edge map; each new frame is compared with the previous one tile
+ * by tile (or the caller names the changed rectangles), and only dirty tiles plus
+ * their 1-pixel halo are recomputed. The edge map always equals a full
+ * EdgeDetector::detectEdges of the frame, so cost scales with motion, not resolution.
+ *
+ * A FrameSequence must not be used by two threads at the same time.
+ */
+class FrameSequence {
+public:
+    /**
+     * @param operatorName "Sobel", "Prewitt" or "Scharr" (case-insensitive)
+     * @throws invalid_argument for unknown operators or a tile size below 2
+     */
+    explicit FrameSequence(const std::string& operatorName, const SequenceOptions& options = {});
+
+    /**
+     * Updates the edge map for the next frame, finding changed tiles by comparing it
+     * with the previous frame. The first frame, and any frame whose size or channel
+     * count differs from the previous one, is computed in full
+     * @param frame View of 1/3/4-channel interleaved pixels; only read during the call
+     * @throws runtime_error for frames < 3x3 pixels or unsupported channel counts
+     */
+    FrameUpdate process(const ImageView& frame);
+
+    /**
+     * Updates the edge map for the next frame without comparing pixels: only tiles
+     * touching dirtyRects are treated as changed. Pixels outside them must equal the
+     * previous frame, otherwise the edge map there is stale
+     * @param dirtyRects Changed rectangles in frame coordinates; may overlap
+     * @throws invalid_argument if a rectangle is empty or outside the frame
+     */
+    FrameUpdate process(const ImageView& frame, const std::vector<Rect>& dirtyRects);
+
+    /**
+     * Forgets the previous frame, so the next one is computed in full
+     */
+    void reset();
+
+private:
+    // Computes the whole frame; false if the frame continues the current geometry
+    bool startFrame(const ImageView& frame);
+    void diffTileRow(const ImageView& frame, int tileRow);
+    void copyDirtyTiles(const ImageView& frame, int tileRow);
+    void recomputeTileRow(const ImageView& frame, int tileRow, EdgeDetector::Workspace& workspace);
+    FrameUpdate update(const ImageView& frame);
+    FrameUpdate result(size_t dirtyTiles, bool fullFrame) const;
+
+    // Calls task(index, worker) for index 0 .. count-1, on the thread pool when options
+    // ask for threads; worker < workspaces.size() is unique among concurrent calls
+    template <typename Task>
+    void forEachIndex(size_t count, Task& task);
+
+    EdgeOperator op;
+    SequenceOptions options;
+
+    int width = 0, height = 0, channels = 0;
+    int tileColumns = 0, tileRows = 0;
+    std::vector<uint8_t> previous;      // Previous input, width * channels bytes per row
+    std::vector<uint8_t> edges;         // Current edge map, width bytes per row
+    std::vector<uint8_t> dirty;         // One flag per tile, row-major
+    std::vector<EdgeDetector::Workspace> workspaces;  // One per worker
+};
@@ -0,0 +1,200 @@
+#pragma once
+#include "EdgeOperators.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Norm used to combine the gradient components gx and gy into an edge magnitude
+ */
+enum class GradientNorm {
+    L2,    // sqrt(gx² + gy²): exact Euclidean magnitude (default)
+    L1,    // |gx| + |gy|: no square root, overestimates diagonal edges
+    LInf   // max(|gx|, |gy|): no square root, underestimates diagonal edges
+};
+
+/**
+ * GradientKernels provides row-level implementations of the 3x3 gradient and
+ * magnitude used by EdgeDetector.
+ * Every row kernel is specialized at compile time for one operator and norm, so
+ * kernel coefficients are immediate constants. The built-in operators get a scalar
+ * reference plus SSE2/AVX2/AVX-512 variants compiled into the same binary; the best
+ * one supported by the running CPU is selected once at startup via cpuid.
+ * All variants produce bit-identical results.
+ */
+class GradientKernels {
+public:
+    /**
+     * Computes one row of edge magnitudes from three padded input rows
+     * @param above, center, below Consecutive rows of width + 2 pixels (1 pixel of padding each side)
+     * @param output Destination for width magnitudes, clamped to [0, 255]
+     * @param width Number of output pixels
+     */
+    using RowKernel = void (*)(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                               uint8_t* output, int width);
+
+    /**
+     * Row kernel that also stores the signed gradient components it computes
+     * @param gx, gy Destinations for width int16 gradients each
+     */
+    using PlaneRowKernel = void (*)(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                                    uint8_t* output, int16_t* gx, int16_t* gy, int width);
+
+    /**
+     * Row kernel for a set of built-in operators: each neighbourhood is loaded once and
+     * the row and column differences all of them share are computed once
+     * @param outputs Destinations of width magnitudes, indexed by EdgeOperator; only the
+     *                entries of operators in the kernel's set are written
+     */
+    using MultiRowKernel = void (*)(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                                    uint8_t* const* outputs, int width);
+
+    // Bit of a built-in operator in the operator sets of multiRowKernel
+    static constexpr unsigned operatorBit(EdgeOperator op) {
+        return 1u << static_cast<int>(op);
+    }
+
+    // A named implementation of the row kernels for every built-in operator and norm
+    struct Variant {
+        const char* name;                  // "scalar", "sse2", "avx2", "avx512"
+        RowKernel kernels[3][3];           // Indexed by [EdgeOperator][GradientNorm]
+        PlaneRowKernel planeKernels[3][3];
+        MultiRowKernel multiKernels[8][3]; // Indexed by [operator set][GradientNorm]
+        bool avx2;                         // Also selects the AVX2 grayscale converter
+
+        RowKernel rowKernel(EdgeOperator op, GradientNorm norm) const {
+            return kernels[static_cast<int>(op)][static_cast<int>(norm)];
+        }
+        PlaneRowKernel planeRowKernel(EdgeOperator op, GradientNorm norm) const {
+            return planeKernels[static_cast<int>(op)][static_cast<int>(norm)];
+        }
+        MultiRowKernel multiRowKernel(unsigned operators, GradientNorm norm) const {
+            return multiKernels[operators & 7][static_cast<int>(norm)];
+        }
+    };
+
+    /**
+     * Returns the variant used by EdgeDetector.
+     * Defaults to the widest ISA supported by the CPU; the EDGE_DETECTOR_ISA
+     * environment variable can force a specific variant by name. Names that are
+     * unknown or unsupported on this CPU print a warning listing the usable ones.
+     */
+    static const Variant& active();
+
+    /**
+     * Lists the variants usable on this CPU, scalar reference first
+     */
+    static std::vector<Variant> available();
+
+    /**
+     * Overrides the active variant
+     * @param name Variant name as reported by available()
+     * @throws invalid_argument if the variant is unknown or unsupported on this CPU
+     */
+    static void select(const std::string& name);
+
+    /**
+     * Returns the active variant's row kernel for a built-in operator
+     */
+    static RowKernel rowKernel(EdgeOperator op, GradientNorm norm) {
+        return active().rowKernel(op, norm);
+    }
+
+    /**
+     * Returns the active variant's gx/gy-storing row kernel for a built-in operator
+     */
+    static PlaneRowKernel planeRowKernel(EdgeOperator op, GradientNorm norm) {
+        return active().planeRowKernel(op, norm);
+    }
+
+    /**
+     * Returns the active variant's row kernel for a set of built-in operators
+     * @param operators OR of operatorBit() of each operator in the set
+     */
+    static MultiRowKernel multiRowKernel(unsigned operators, GradientNorm norm) {
+        return active().multiRowKernel(operators, norm);
+    }
+
+    /**
+     * Quantizes gradient directions into 45-degree bins centered on the axes and diagonals.
+     * Angles follow image coordinates (y down): with 8 bins, 0 = +x, 2 = +y (down), 4 = -x,
+     * 6 = -y; with 4 bins opposite directions share a bin (8-bin value mod 4).
+     * Pixels without gradient get bin 0.
+     * @param bins 4 or 8
+     */
+    static void orientationRow(const int16_t* gx, const int16_t* gy, uint8_t* output, int width, int bins);
+
+    /**
+     * Returns a portable row kernel for any operator policy (see EdgeOperators.h),
+     * with all nine taps unrolled and zero coefficients removed at compile time
+     */
+    template <typename Operator>
+    static RowKernel unrolledRowKernel(GradientNorm norm) {
+        switch (norm) {
+        case GradientNorm::L1: return unrolledRow<Operator, GradientNorm::L1>;
+        case GradientNorm::LInf: return unrolledRow<Operator, GradientNorm::LInf>;
+        default: return unrolledRow<Operator, GradientNorm::L2>;
+        }
+    }
+
+    /**
+     * floor(sqrt(n)) for every n below 255², built with integer arithmetic only
+     */
+    static const uint8_t* squareRootTable();
+
+    /**
+     * Combines gradient components into a magnitude clamped to [0, 255].
+     * L2 is the Euclidean norm sqrt(gx² + gy²), identical to truncating the
+     * double-precision square root; L1 and L-infinity avoid the root entirely.
+     */
+    template <GradientNorm Norm>
+    static uint8_t magnitude(int gx, int gy, const uint8_t* sqrtTable) {
+        if constexpr (Norm == GradientNorm::L2) {
+            int sumOfSquares = gx * gx + gy * gy;
+            return sumOfSquares >= 255 * 255 ? 255 : sqrtTable[sumOfSquares];
+        } else if constexpr (Norm == GradientNorm::L1) {
+            return static_cast<uint8_t>(std::min(255, std::abs(gx) + std::abs(gy)));
+        } else {
+            return static_cast<uint8_t>(std::min(255, std::max(std::abs(gx), std::abs(gy))));
+        }
+    }
+
+private:
+    // Weighted pixel of tap [Tap / 3][Tap % 3]; zero taps vanish and unit taps skip the multiply
+    template <int Weight, int Tap>
+    static int tap(const uint8_t* const rows[3], int x) {
+        if constexpr (Weight == 0) {
+            return 0;
+        } else if constexpr (Weight == 1) {
+            return rows[Tap / 3][x + Tap % 3];
+        } else if constexpr (Weight == -1) {
+            return -rows[Tap / 3][x + Tap % 3];
+        } else {
+            return Weight * rows[Tap / 3][x + Tap % 3];
+        }
+    }
+
+    template <typename Operator, size_t... Taps>
+    static void gradient(const uint8_t* const rows[3], int x, int& gx, int& gy, std::index_sequence<Taps...>) {
+        gx = (tap<Operator::kernelX[Taps / 3][Taps % 3], Taps>(rows, x) + ...);
+        gy = (tap<Operator::kernelY[Taps / 3][Taps % 3], Taps>(rows, x) + ...);
+    }
+
+    template <typename Operator, GradientNorm Norm>
+    static void unrolledRow(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                            uint8_t* output, int width) {
+        // |gx|, |gy| <= 255 * 128 keeps gx² + gy² within int
+        static_assert(EdgeOperatorTraits::absoluteWeight<Operator>() <= 128,
+                      "Sum of absolute kernel weights must not exceed 128");
+        const uint8_t* sqrtTable = squareRootTable();
+        const uint8_t* const rows[3] = {above, center, below};
+        for (int x = 0; x < width; ++x) {
+            int gx, gy;
+            gradient<Operator>(rows, x, gx, gy, std::make_index_sequence<9>());
+            output[x] = magnitude<Norm>(gx, gy, sqrtTable);
+        }
+    }
+};
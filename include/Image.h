@@ -2,11 +2,88 @@
 #include <string>    
 #include <vector>    
 #include <cstdint>   
+#include <cstddef>
+#include <memory>
+#include <algorithm>
+#include "PngEncoder.h"
+
+class MappedFile;
+
+/**
+ * Read-only view of contiguous bytes (stand-in for C++20 std::span<const uint8_t>).
+ * Does not own the bytes; the owner must outlive the span.
+ */
+class ByteSpan {
+public:
+    ByteSpan(const uint8_t* data, size_t size) : bytes(data), length(size) {}
+    ByteSpan(const std::vector<uint8_t>& vector) : bytes(vector.data()), length(vector.size()) {}
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    const uint8_t& operator[](size_t index) const { return bytes[index]; }
+    const uint8_t* begin() const { return bytes; }
+    const uint8_t* end() const { return bytes + length; }
+
+    // Element-wise comparison (also against std::vector via implicit conversion)
+    friend bool operator==(const ByteSpan& a, const ByteSpan& b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+    }
+    friend bool operator!=(const ByteSpan& a, const ByteSpan& b) { return !(a == b); }
+
+private:
+    const uint8_t* bytes;
+    size_t length;
+};
+
+/**
+ * Non-owning view of interleaved pixel data.
+ * Rows may be padded or belong to a larger buffer: row y starts at data + y * stride.
+ */
+struct ImageView {
+    const uint8_t* data;  // First pixel of row 0
+    int width;            // Width in pixels
+    int height;           // Height in pixels
+    int channels;         // Interleaved channels per pixel (1, 3 or 4)
+    size_t stride;        // Bytes between the starts of consecutive rows
+
+    const uint8_t* row(int y) const { return data + static_cast<size_t>(y) * stride; }
+};
+
+/**
+ * Luma coefficients used for grayscale conversion
+ */
+enum class LumaWeights {
+    BT601,   // 0.299 R + 0.587 G + 0.114 B (SD video, JPEG; default)
+    BT709    // 0.2126 R + 0.7152 G + 0.0722 B (HD video, sRGB)
+};
+
+/**
+ * Options for Image::loadFromFile
+ */
+struct LoadOptions {
+    // Return a single-channel image converted while loading. BT.601 JPEGs decode
+    // only their luma plane, skipping chroma upsampling and color conversion
+    bool grayscale = false;
+    LumaWeights luma = LumaWeights::BT601;
+};
+
+/**
+ * Rectangle of pixels in image coordinates
+ */
+struct Rect {
+    int x;       // Leftmost column
+    int y;       // Top row
+    int width;
+    int height;
+};
 
 /**
  * Image class for loading, saving, and processing image data.
  * Supports PNG, JPG formats with RGB/RGBA/Grayscale conversion.
+ * Binary PGM/PPM and headerless raw files are memory-mapped instead of decoded.
  * Minimum size requirement: 3x3 pixels for edge detection compatibility.
+ * Pixel storage is immutable and shared: copying an Image never copies pixels.
  */
 class Image {
 public:
@@ -19,35 +96,120 @@ public:
      */
     Image(std::vector<uint8_t> data, int width, int height, int channels);
     
+    /**
+     * Constructor: Adopts an existing pixel buffer without copying
+     * @param pixels Buffer of width * height * channels bytes; its deleter releases
+     *               the memory once the last Image sharing it is gone (e.g. stbi_image_free)
+     * @param width Image width in pixels
+     * @param height Image height in pixels
+     * @param channels Number of color channels (1=grayscale, 3=RGB, 4=RGBA)
+     */
+    Image(std::shared_ptr<const uint8_t> pixels, int width, int height, int channels);
+    
     /**
      * Loads image from file using STB library
-     * @param filepath Path to image file (PNG, JPG, etc.)
+     * @param filepath Path to image file (PNG, JPG, etc.); .pgm/.ppm/.pnm files are
+     *                 memory-mapped and the Image points straight into the mapping
+     * @param options Optional conversion to grayscale at load time
      * @return Image object with loaded data
      * @throws runtime_error if file not found or invalid format
      */
-    static Image loadFromFile(const std::string& filepath);
+    static Image loadFromFile(const std::string& filepath, const LoadOptions& options = {});
+    
+    /**
+     * Decodes an image held in memory (PNG, JPG, PGM/PPM, etc.), e.g. a request body,
+     * without touching the filesystem
+     * @param encoded Encoded file contents; only read during the call
+     * @param options Optional conversion to grayscale at load time
+     * @throws invalid_argument if encoded is empty
+     * @throws runtime_error if the data cannot be decoded
+     */
+    static Image loadFromMemory(ByteSpan encoded, const LoadOptions& options = {});
+    
+    /**
+     * Memory-maps a headerless raw file of interleaved 8-bit pixels without copying
+     * @param filepath Path to a file of exactly width * height * channels bytes
+     * @throws runtime_error if the file cannot be mapped or its size does not match
+     */
+    static Image loadRaw(const std::string& filepath, int width, int height, int channels);
     
     /**
-     * Saves image to PNG file
+     * Saves image to PNG file, or to a pre-sized memory-mapped PGM/PPM (.pgm/.ppm/.pnm)
+     * or headerless raw (.raw) file without encoding
      * @param filepath Output file path
+     * @param options PNG compression level, filter and encoder threads (ignored for PGM/PPM/raw)
      * @throws runtime_error if save fails
+     * @throws invalid_argument for invalid PNG options
+     */
+    void saveToFile(const std::string& filepath, const PngOptions& options = {}) const;
+    
+    /**
+     * Encodes the image as PNG into a reused buffer, without touching the filesystem
+     * @param output Replaced by the PNG bytes; its capacity is kept across calls
+     * @throws invalid_argument for invalid PNG options
+     */
+    void encodePng(std::vector<uint8_t>& output, const PngOptions& options = {}) const;
+    
+    /**
+     * Encodes the image as PNG piece by piece, e.g. straight into a socket
+     * @param write Receives consecutive pieces of the PNG stream
+     * @see PngEncoder::encodeToCallback
      */
-    void saveToFile(const std::string& filepath) const;
+    void encodeToCallback(const PngEncoder::WriteFunction& write, const PngOptions& options = {}) const;
     
     /**
      * Converts RGB/RGBA image to grayscale using luminosity formula
-     * @return New grayscale Image object 
+     * @param luma BT.601 (default) or BT.709 coefficients
+     * @param threads Threads converting row blocks: 1 = single-threaded (default), 0 = all cores
+     * @return New grayscale Image object (shares pixels if already grayscale)
      * @throws runtime_error if unsupported channel count
      */
-    Image toGrayscale() const;
+    Image toGrayscale(LumaWeights luma = LumaWeights::BT601, unsigned threads = 1) const;
+    
+    /**
+     * Parses a luma standard name
+     * @param name "BT601" or "BT709" (case-insensitive, '.' optional)
+     * @throws invalid_argument for unknown standards
+     */
+    static LumaWeights parseLuma(const std::string& name);
+
+    /**
+     * Converts interleaved pixels to grayscale with the same formula as toGrayscale():
+     * Q16 fixed-point weights, truncated, vectorized with AVX2 where available
+     * @param source Interleaved pixels (1, 3 or 4 channels)
+     * @param destination Output buffer of pixelCount bytes
+     * @param pixelCount Number of pixels to convert
+     * @param channels Channel count of source (1 = plain copy)
+     */
+    static void convertToGrayscale(const uint8_t* source, uint8_t* destination,
+                                   size_t pixelCount, int channels,
+                                   LumaWeights luma = LumaWeights::BT601);
     
     // Accessor methods for image properties
     int getWidth() const { return width; }
     int getHeight() const { return height; }
     int getChannels() const { return channels; }
-    const std::vector<uint8_t>& getData() const { return data; }
+    ByteSpan getData() const { return ByteSpan(pixels.get(), getDataSize()); }
+    size_t getDataSize() const { return static_cast<size_t>(width) * height * channels; }
+    
+    // Non-owning view of the pixels, valid while this Image (or a copy) is alive
+    ImageView view() const {
+        return ImageView{pixels.get(), width, height, channels, static_cast<size_t>(width) * channels};
+    }
 
 private:
-    std::vector<uint8_t> data;    // Raw pixel data
-    int width, height, channels;  // Image dimensions and format
+    /**
+     * Returns an Image of the mapped pixels starting at dataOffset, sharing ownership of the mapping
+     * @throws runtime_error if the mapping is too short or the geometry is unsupported
+     */
+    static Image fromMapping(std::shared_ptr<MappedFile> mapping, size_t dataOffset,
+                             int width, int height, int channels);
+    
+    /**
+     * Writes header followed by the pixels into a pre-sized mapped file
+     */
+    void saveMapped(const std::string& filepath, const std::string& header) const;
+    
+    std::shared_ptr<const uint8_t> pixels;  // Raw pixel data (shared, immutable)
+    int width, height, channels;            // Image dimensions and format
 };
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * MappedFile maps a whole file into memory (POSIX mmap).
+ * Read mappings are shared and read-only; created files are pre-sized and
+ * mapped writable so results can be stored without intermediate buffers.
+ * The mapping is released when the last shared_ptr to it is destroyed.
+ *
+ * Created files are written to a temporary file next to the target and only
+ * replace it on commit(), so a target that is itself mapped for reading (e.g.
+ * an image saved over the file it was loaded from) is never truncated under
+ * its readers, and a failed write leaves the old file intact.
+ */
+class MappedFile {
+public:
+    /**
+     * Maps an existing file read-only
+     * @throws runtime_error if the file cannot be opened or mapped
+     */
+    static std::shared_ptr<MappedFile> openRead(const std::string& filepath);
+
+    /**
+     * Creates a temporary file of exactly size bytes next to filepath and maps it
+     * writable; commit() moves it to filepath. Without commit() the temporary file
+     * is removed and filepath stays untouched
+     * @throws runtime_error if the file cannot be created, sized or mapped
+     */
+    static std::shared_ptr<MappedFile> create(const std::string& filepath, size_t size);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    /**
+     * Writable bytes of a mapping made by create()
+     * @throws logic_error for read-only mappings
+     */
+    uint8_t* mutableData();
+
+    /**
+     * Flushes a mapping made by create() to disk, unmaps it and renames the temporary
+     * file over the target. The data is no longer accessible afterwards
+     * @throws runtime_error if writing back, unmapping or renaming fails
+     * @throws logic_error for read-only or already committed mappings
+     */
+    void commit();
+
+private:
+    MappedFile(uint8_t* bytes, size_t length, bool writable, std::string filepath, std::string temporaryPath);
+
+    uint8_t* bytes;
+    size_t length;
+    bool writable;
+    std::string filepath;
+    std::string temporaryPath;  // File mapped by create() until commit() renames it
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct ImageView;
+
+/**
+ * PNG scanline filter applied before compression
+ */
+enum class PngFilter {
+    None,      // Raw bytes: cheapest, compresses flat regions well
+    Sub,       // Difference to the pixel on the left
+    Up,        // Difference to the pixel above
+    Average,   // Difference to the mean of left and above
+    Paeth,     // Difference to the Paeth predictor
+    Adaptive   // Per row, the filter with the smallest sum of absolute residuals (default)
+};
+
+/**
+ * Encoder settings for PngEncoder and Image::saveToFile
+ */
+struct PngOptions {
+    // 0 = stored (no compression, fastest), 1 = fastest compression ... 9 = smallest output
+    int compressionLevel = 6;
+
+    PngFilter filter = PngFilter::Adaptive;
+
+    // Threads compressing row chunks: 1 = single-threaded (default), 0 = hardware_concurrency()
+    unsigned threads = 1;
+};
+
+/**
+ * PngEncoder writes 8-bit gray/gray+alpha/RGB/RGBA PNG files.
+ * Rows are split into chunks of roughly 256KB that are filtered and deflated
+ * independently and joined with byte-aligned sync points into one zlib stream,
+ * so chunks can be compressed in parallel. Chunking does not depend on the thread
+ * count: the output is byte-identical for any number of threads.
+ */
+class PngEncoder {
+public:
+    // Receives consecutive pieces of the PNG stream
+    using WriteFunction = std::function<void(const uint8_t* data, size_t size)>;
+
+    /**
+     * Encodes an image into PNG file contents
+     * @param image 1-4 channel interleaved pixels; rows may be strided
+     * @throws invalid_argument for invalid options, dimensions or channel counts
+     */
+    static std::vector<uint8_t> encode(const ImageView& image, const PngOptions& options = {});
+
+    /**
+     * Encodes an image into a reused buffer: output is replaced, and its capacity
+     * is kept, so encoding same-sized images in a loop stops reallocating it
+     * @see encode
+     */
+    static void encodeInto(const ImageView& image, std::vector<uint8_t>& output, const PngOptions& options = {});
+
+    /**
+     * Encodes an image piece by piece (signature and header, one IDAT chunk per row
+     * chunk, trailer), e.g. straight into a socket. Single-threaded, each IDAT chunk
+     * is written as soon as it is compressed
+     * @param write Called in stream order; exceptions it throws abort the encoding
+     * @see encode
+     */
+    static void encodeToCallback(const ImageView& image, const WriteFunction& write, const PngOptions& options = {});
+
+    /**
+     * Parses a filter name
+     * @param name "none", "sub", "up", "average", "paeth" or "adaptive" (case-insensitive)
+     * @throws invalid_argument for unknown filters
+     */
+    static PngFilter parseFilter(const std::string& name);
+};
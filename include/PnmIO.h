@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Header fields of a binary PGM (P5) or PPM (P6) file with 8-bit samples
+ */
+struct PnmHeader {
+    int width = 0;
+    int height = 0;
+    int channels = 0;        // 1 for PGM (P5), 3 for PPM (P6)
+    size_t dataOffset = 0;   // Byte offset of the first pixel
+};
+
+/**
+ * PnmIO parses and formats headers of the uncompressed Netpbm formats.
+ * Pixel rows follow the header contiguously, which makes these formats
+ * suitable for strip-wise streaming and direct memory mapping.
+ */
+class PnmIO {
+public:
+    /**
+     * Parses a P5/P6 header (comments allowed, maxval must be 255)
+     * @param bytes Start of the file contents
+     * @param size Number of bytes available
+     * @throws runtime_error for malformed or unsupported headers
+     */
+    static PnmHeader parseHeader(const uint8_t* bytes, size_t size);
+
+    /**
+     * Formats a header for a 1-channel (P5) or 3-channel (P6) image
+     * @throws invalid_argument for other channel counts
+     */
+    static std::string formatHeader(int width, int height, int channels);
+
+    /**
+     * Checks whether a path has a .pgm, .ppm or .pnm extension (case-insensitive)
+     */
+    static bool hasPnmExtension(const std::string& path);
+};
+
+/**
+ * Sequential reader of interleaved 8-bit scanlines from a PGM/PPM or headerless
+ * raw file; only the rows requested by each call are held in memory
+ */
+class ScanlineReader {
+public:
+    /**
+     * Opens a binary PGM/PPM file
+     * @throws runtime_error if the file cannot be opened or has an invalid header
+     */
+    static ScanlineReader openPnm(const std::string& filepath);
+
+    /**
+     * Opens a headerless raw file of width * height * channels bytes
+     * @throws runtime_error if the file cannot be opened or its size does not match
+     */
+    static ScanlineReader openRaw(const std::string& filepath, int width, int height, int channels);
+
+    /**
+     * Reads the next rowCount rows into destination (rowCount * width * channels bytes)
+     * @throws runtime_error if the file ends early
+     */
+    void readRows(uint8_t* destination, int rowCount);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getChannels() const { return channels; }
+
+private:
+    ScanlineReader(const std::string& filepath, int width, int height, int channels, size_t dataOffset);
+
+    std::ifstream stream;
+    std::string filepath;
+    int width, height, channels;
+    int rowsRead = 0;
+};
+
+/**
+ * Sequential writer of 8-bit scanlines to a PGM/PPM file (or a raw file when the
+ * path has no Netpbm extension); rows are written as soon as they are produced
+ */
+class ScanlineWriter {
+public:
+    /**
+     * Creates the output file and writes its header
+     * @throws runtime_error if the file cannot be created
+     */
+    ScanlineWriter(const std::string& filepath, int width, int height, int channels);
+
+    /**
+     * Appends rowCount rows (rowCount * width * channels bytes)
+     * @throws runtime_error on write errors or when more rows than height are written
+     */
+    void writeRows(const uint8_t* rows, int rowCount);
+
+    /**
+     * Flushes the file and checks that every row was written
+     * @throws runtime_error if the image is incomplete or the flush fails
+     */
+    void finish();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getChannels() const { return channels; }
+
+private:
+    std::ofstream stream;
+    std::string filepath;
+    int width, height, channels;
+    int rowsWritten = 0;
+};
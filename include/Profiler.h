@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * One completed pipeline stage
+ */
+struct ProfileEvent {
+    const char* name;          // Stage name, e.g. "decode", "detect", "encode"
+    std::string detail;        // Optional context such as the file path
+    uint32_t thread;           // Small sequential id of the recording thread
+    int64_t startNs;           // Start time relative to Profiler::enable()
+    int64_t durationNs;        // Wall time
+    size_t bytes;              // Bytes read plus written by the stage
+    bool memorySampled;        // False for stages on worker threads, which leave the next two 0
+    int64_t heapDeltaBytes;    // Change of malloc'ed bytes in use over the stage
+    int64_t peakGrowthBytes;   // How far the stage raised the process peak RSS
+};
+
+/**
+ * Profiler records scoped stage timings across Image, EdgeDetector and the encoders.
+ * Instrumentation is off by default; a disabled Profiler::Scope costs one relaxed
+ * atomic load and no allocation, so it can stay in hot paths. Stages are meant to
+ * be coarse (per image, band or chunk), not per row.
+ *
+ * Heap and peak RSS figures are process-wide, so they are only sampled for stages on
+ * threads that do not run alongside others. Stages inside a WorkerSection, such as
+ * ThreadPool tasks and batch pipeline stages, record time and bytes only; sampling
+ * there would count other threads' allocations and lock the malloc arenas under them.
+ */
+class Profiler {
+public:
+    /**
+     * RAII stage marker: records an event on destruction while profiling is enabled
+     */
+    class Scope {
+    public:
+        explicit Scope(const char* name, size_t bytes = 0, const std::string& detail = std::string())
+            : name(Profiler::isEnabled() ? name : nullptr) {
+            if (this->name) {
+                begin(bytes, detail);
+            }
+        }
+        ~Scope() {
+            if (name) {
+                end();
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        // Sets the byte count once it is known, e.g. after decoding
+        void setBytes(size_t bytes) {
+            if (name) {
+                event.bytes = bytes;
+            }
+        }
+
+    private:
+        const char* name;
+        ProfileEvent event{};
+        int64_t startHeap = 0;
+        int64_t startPeak = 0;
+
+        void begin(size_t bytes, const std::string& detail);
+        void end();
+    };
+
+    /**
+     * RAII marker for code running concurrently with other threads: Scopes opened on
+     * this thread meanwhile skip memory sampling. Sections nest
+     */
+    class WorkerSection {
+    public:
+        WorkerSection() : outer(workerDepth++) {}
+        ~WorkerSection() { workerDepth = outer; }
+        WorkerSection(const WorkerSection&) = delete;
+        WorkerSection& operator=(const WorkerSection&) = delete;
+
+    private:
+        unsigned outer;
+    };
+
+    /**
+     * Turns recording on or off; enabling also clears previously recorded events
+     */
+    static void enable(bool on = true);
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns a copy of the events recorded so far, in completion order
+     */
+    static std::vector<ProfileEvent> events();
+
+    /**
+     * Formats a per-stage breakdown: calls, total and mean time, share of the
+     * profiled wall time, bytes touched, throughput and memory growth
+     */
+    static std::string summary();
+
+    /**
+     * Writes the events in Chrome trace_event format (chrome://tracing, Perfetto)
+     * @throws runtime_error if the file cannot be written
+     */
+    static void writeChromeTrace(const std::string& path);
+
+private:
+    static std::atomic<bool> enabled;
+    static thread_local unsigned workerDepth;   // Open WorkerSections on this thread
+};
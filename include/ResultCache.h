@@ -0,0 +1,105 @@
+#pragma once
+#include "EdgeDetector.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * Counters of a ResultCache, summed over all threads using it
+ */
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t stores = 0;       // Results added to the cache
+    size_t evictions = 0;    // Entries removed to stay within the size limit
+};
+
+/**
+ * ResultCache keeps finished output files in a local directory, keyed by the content
+ * of the input and every setting that shapes the output. A hit copies the stored file
+ * to the output path, skipping decode, detection and encode entirely.
+ *
+ * Keys are content-addressed: the input file bytes (or decoded pixels) are hashed, so
+ * renamed or copied inputs still hit and a rewritten file with the same name misses.
+ * Entries are written to a private temporary file and renamed into place, so processes
+ * sharing a directory never see partial results. The directory is kept below a byte
+ * limit by evicting the least recently used entries; a hit refreshes the entry's
+ * modification time, which serves as its last-use time.
+ *
+ * Cache problems (unreadable entries, full disks) only cost a miss and never fail the
+ * caller. All methods are safe to call from several threads.
+ */
+class ResultCache {
+public:
+    static constexpr uint64_t DEFAULT_MAX_BYTES = 1ull << 30;
+
+    /**
+     * @param directory Cache directory, created on the first store
+     * @param maxBytes Total size of the entries kept; older entries are evicted beyond it
+     */
+    explicit ResultCache(const std::string& directory, uint64_t maxBytes = DEFAULT_MAX_BYTES);
+
+    /**
+     * Content hash of an input file's bytes
+     * @throws runtime_error if the file cannot be read
+     */
+    static uint64_t fileHash(const std::string& path);
+
+    /**
+     * Content hash of decoded pixels: the dimensions and the visible bytes of every row,
+     * so the row stride does not matter
+     */
+    static uint64_t pixelHash(const ImageView& image);
+
+    /**
+     * Cache key of an input with the given content hash
+     * @param settings Description of everything besides the input that shapes the output,
+     *                 e.g. from describe()
+     * @return 16 hex digits
+     */
+    static std::string key(uint64_t contentHash, const std::string& settings);
+
+    /**
+     * Describes the settings that determine an edge detection output file. Threads and
+     * tiling are left out since they do not change results
+     * @param extension Output format, e.g. ".png"
+     */
+    static std::string describe(const std::string& operatorName, const EdgeDetectionOptions& detection,
+                                const LoadOptions& load, const PngOptions& png, const std::string& extension);
+
+    /**
+     * 64-bit XXH64 hash of data; about as fast as reading the memory
+     */
+    static uint64_t hash(ByteSpan data, uint64_t seed = 0);
+
+    /**
+     * Copies the entry of key to outputPath and marks it as recently used
+     * @return true on a hit; false (counted as a miss) if there is no usable entry
+     */
+    bool fetch(const std::string& key, const std::string& outputPath);
+
+    /**
+     * Adds the finished output file under key, then evicts least recently used entries
+     * until the directory fits the size limit. Failures are ignored
+     */
+    void store(const std::string& key, const std::string& outputPath);
+
+    CacheStats stats() const;
+
+    const std::string& directory() const { return root; }
+
+private:
+    // Removes the oldest entries until the total size fits maxBytes; caller holds the mutex.
+    // Temporary files of stores in flight are skipped, and removed only when an hour old
+    void evict();
+
+    std::string root;
+    uint64_t maxBytes;
+
+    std::mutex mutex;              // Guards the size estimate and eviction
+    uint64_t knownBytes = 0;       // Size of the entries, rescanned when over the limit
+    bool scanned = false;
+
+    std::atomic<size_t> hits{0}, misses{0}, stores{0}, evictions{0};
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * ThreadPool keeps a fixed set of worker threads alive between calls so that
+ * per-image parallel work does not pay thread creation costs.
+ * Work is submitted as an indexed loop; the calling thread participates.
+ */
+class ThreadPool {
+public:
+    /**
+     * Creates a pool
+     * @param threadCount Total threads including the caller (0 = hardware_concurrency)
+     * @throws system_error if a worker thread cannot be started; workers already running
+     *         are joined first
+     */
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Runs task(0) ... task(count - 1) across the pool and waits for completion.
+     * Concurrent callers are serialized; tasks must not call parallelFor on the same pool.
+     * @throws The first exception thrown by any task, after all tasks finished
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+
+    // Number of threads taking part in parallelFor, including the caller
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    /**
+     * Returns a process-wide pool with the given thread count, created on first use
+     * @param threadCount Total threads; 0 and counts above hardware_concurrency all map to
+     *                    the one hardware_concurrency pool
+     */
+    static ThreadPool& shared(unsigned threadCount = 0);
+
+private:
+    void workerLoop();
+    void runTasks();
+    void stopWorkers();
+
+    std::vector<std::thread> workers;
+    std::mutex submitMutex;             // Serializes parallelFor callers
+
+    std::mutex mutex;                   // Guards the fields below
+    std::condition_variable wake;       // Signals a new job or shutdown
+    std::condition_variable finished;   // Signals that all workers left the job
+    const std::function<void(size_t)>* task = nullptr;
+    size_t taskCount = 0;
+    size_t busyWorkers = 0;
+    unsigned long long generation = 0;  // Incremented per job so workers join each job once
+    bool stopping = false;
+    std::exception_ptr error;
+
+    std::atomic<size_t> nextIndex{0};
+};
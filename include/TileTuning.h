@@ -0,0 +1,60 @@
+#pragma once
+#include "EdgeDetector.h"
+#include <optional>
+#include <string>
+
+/**
+ * TileTuning picks EdgeDetectionOptions::tiles for the machine it runs on. A short
+ * calibration times candidate tile sizes on a synthetic wide color image; the winner
+ * is stored in a small text file so later processes skip the calibration:
+ *
+ *   # edge_detector tile tuning
+ *   variant avx2
+ *   tile 1024x32
+ *
+ * A file written for a different row kernel variant (see GradientKernels::select) is
+ * treated as stale and tuned again.
+ */
+class TileTuning {
+public:
+    /**
+     * Times every candidate tile size, single-threaded, with the active row kernels
+     * @return Fastest tile size; untiled ({0, 0}) unless a tiling is clearly faster
+     */
+    static TileSize calibrate();
+
+    /**
+     * Reads a tuning file written by save()
+     * @return Stored tile size, or nothing if the file is missing, malformed or stale
+     */
+    static std::optional<TileSize> load(const std::string& path);
+
+    /**
+     * Writes a tuning file for the active row kernel variant, creating parent directories
+     * @throws runtime_error if the file cannot be written
+     */
+    static void save(const std::string& path, const TileSize& tiles);
+
+    /**
+     * Tile size stored in path, calibrating and saving it first when the file is missing
+     * or stale; the result is kept for the rest of the process
+     * @param path Tuning file; empty uses defaultPath()
+     */
+    static TileSize tuned(const std::string& path = "");
+
+    /**
+     * $XDG_CACHE_HOME/edge_detector/tiles.conf, else ~/.cache/edge_detector/tiles.conf,
+     * else edge_detector_tiles.conf in the working directory
+     */
+    static std::string defaultPath();
+
+    /**
+     * Parses a tile size
+     * @param text "WxH" with 0 for a whole-region dimension, e.g. "1024x32" or "0x64"
+     * @throws invalid_argument for malformed or negative sizes
+     */
+    static TileSize parse(const std::string& text);
+
+    // Formats a tile size as parse() reads it
+    static std::string format(const TileSize& tiles);
+};
@@ -0,0 +1,199 @@
+#include "BatchProcessor.h"
+#include "BoundedQueue.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+
+// An image travelling between stages, tagged with its position in the input list
+struct BatchItem {
+    size_t index = 0;
+    std::optional<Image> image;
+    std::string cacheKey;       // Key the finished output is stored under, when caching
+};
+
+// Extensions STB can decode; anything else in a directory is skipped
+bool isImageFile(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    static const char* const supported[] = {".png", ".jpg", ".jpeg", ".bmp", ".tga", ".gif", ".psd", ".pnm", ".pgm", ".ppm"};
+    return std::find(std::begin(supported), std::end(supported), extension) != std::end(supported);
+}
+
+unsigned resolveWorkers(unsigned requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    return std::max(1u, std::thread::hardware_concurrency() / 2);
+}
+
+} // namespace
+
+std::vector<std::string> BatchProcessor::collectInputs(const std::string& source) {
+    std::error_code ec;
+    std::vector<std::string> inputs;
+
+    if (std::filesystem::is_directory(source, ec)) {
+        for (const auto& entry : std::filesystem::directory_iterator(source, ec)) {
+            if (entry.is_regular_file() && isImageFile(entry.path())) {
+                inputs.push_back(entry.path().string());
+            }
+        }
+        // Directory iteration order is unspecified; sort for reproducible runs
+        std::sort(inputs.begin(), inputs.end());
+    } else if (std::filesystem::is_regular_file(source, ec)) {
+        std::ifstream list(source);
+        std::string line;
+        while (std::getline(list, line)) {
+            // Trim surrounding whitespace (including '\r' from Windows line endings)
+            line.erase(0, line.find_first_not_of(" \t\r"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#') {
+                inputs.push_back(line);
+            }
+        }
+    } else {
+        throw std::runtime_error("Batch source is neither a directory nor a file list: " + source);
+    }
+
+    if (ec) {
+        throw std::runtime_error("Error reading batch source: " + source + " (" + ec.message() + ")");
+    }
+    if (inputs.empty()) {
+        throw std::runtime_error("No input images found in: " + source);
+    }
+    return inputs;
+}
+
+std::vector<std::string> BatchProcessor::outputPaths(const std::vector<std::string>& inputs,
+                                                     const std::string& operatorName,
+                                                     const std::string& outputDir) {
+    std::vector<std::string> outputs;
+    std::map<std::string, int> suffixes;
+    std::set<std::string> emitted;
+
+    // Suffixed names can collide with real stems (a/foo, b/foo, c/foo_1), so every
+    // candidate is checked against all names handed out so far
+    for (const auto& input : inputs) {
+        std::string stem = std::filesystem::path(input).stem().string();
+        std::string name = stem;
+        int& suffix = suffixes[stem];
+        while (!emitted.insert(name).second) {
+            name = stem + "_" + std::to_string(++suffix);
+        }
+        outputs.push_back((std::filesystem::path(outputDir) / (name + "_" + operatorName + "_edges.png")).string());
+    }
+    return outputs;
+}
+
+BatchResult BatchProcessor::run(const std::vector<std::string>& inputs, const BatchOptions& options) {
+    // Fail fast on configuration errors instead of once per image
+    EdgeDetector::validateOperator(options.operatorName);
+
+    BatchResult result;
+    auto start = std::chrono::steady_clock::now();
+
+    std::filesystem::create_directories(options.outputDir);
+    std::vector<std::string> outputs = outputPaths(inputs, options.operatorName, options.outputDir);
+
+    BoundedQueue<BatchItem> decoded(options.queueCapacity);
+    BoundedQueue<BatchItem> detected(options.queueCapacity);
+
+    std::mutex errorMutex;
+    auto recordError = [&](size_t index, const std::string& message) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        result.errors.push_back(inputs[index] + ": " + message);
+    };
+
+    // Stage 1: decode. Workers claim inputs in order; the last one to finish closes the queue.
+    // Inputs whose result is cached are copied from the cache and go no further
+    std::string cacheSettings = options.cache ? ResultCache::describe(options.operatorName, options.detection,
+                                                                      options.load, options.png, ".png")
+                                              : "";
+    std::atomic<size_t> succeeded{0};
+    std::atomic<size_t> nextInput{0};
+    std::atomic<unsigned> activeDecoders{resolveWorkers(options.decodeThreads)};
+    std::vector<std::thread> decoders;
+    for (unsigned i = 0, count = activeDecoders.load(); i < count; ++i) {
+        decoders.emplace_back([&] {
+            Profiler::WorkerSection section;  // Stages overlap across the pipeline threads
+            size_t index;
+            while ((index = nextInput.fetch_add(1)) < inputs.size()) {
+                try {
+                    std::string cacheKey;
+                    if (options.cache) {
+                        cacheKey = ResultCache::key(ResultCache::fileHash(inputs[index]), cacheSettings);
+                        if (options.cache->fetch(cacheKey, outputs[index])) {
+                            ++succeeded;
+                            continue;
+                        }
+                    }
+                    decoded.push(BatchItem{index, Image::loadFromFile(inputs[index], options.load), cacheKey});
+                } catch (const std::exception& e) {
+                    recordError(index, e.what());
+                }
+            }
+            if (--activeDecoders == 0) {
+                decoded.close();
+            }
+        });
+    }
+
+    // Stage 2: edge detection. A single stage thread; detectEdges itself may use the thread pool
+    std::thread detector([&] {
+        Profiler::WorkerSection section;
+        BatchItem item;
+        while (decoded.pop(item)) {
+            try {
+                Image edges = EdgeDetector::detectEdges(*item.image, options.operatorName, options.detection);
+                detected.push(BatchItem{item.index, std::move(edges), std::move(item.cacheKey)});
+            } catch (const std::exception& e) {
+                recordError(item.index, e.what());
+            }
+        }
+        detected.close();
+    });
+
+    // Stage 3: encode and write
+    std::vector<std::thread> encoders;
+    for (unsigned i = 0, count = resolveWorkers(options.encodeThreads); i < count; ++i) {
+        encoders.emplace_back([&] {
+            Profiler::WorkerSection section;
+            BatchItem item;
+            while (detected.pop(item)) {
+                try {
+                    item.image->saveToFile(outputs[item.index], options.png);
+                    if (options.cache) {
+                        options.cache->store(item.cacheKey, outputs[item.index]);
+                    }
+                    ++succeeded;
+                } catch (const std::exception& e) {
+                    recordError(item.index, e.what());
+                }
+            }
+        });
+    }
+
+    for (auto& thread : decoders) {
+        thread.join();
+    }
+    detector.join();
+    for (auto& thread : encoders) {
+        thread.join();
+    }
+
+    result.succeeded = succeeded;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
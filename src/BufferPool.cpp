@@ -0,0 +1,48 @@
+#include "BufferPool.h"
+
+BufferPool::BufferPool(size_t maxBuffers) : maxBuffers(maxBuffers) {
+    buffers.reserve(maxBuffers);
+}
+
+std::shared_ptr<uint8_t> BufferPool::acquire(size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Prefer a free buffer that is already large enough, then any free buffer.
+    // use_count() == 1 is reliable here: only the pool can hand out new references
+    // and it does so under the mutex
+    std::shared_ptr<std::vector<uint8_t>>* reusable = nullptr;
+    for (auto& buffer : buffers) {
+        if (buffer.use_count() == 1) {
+            if (buffer->size() >= size) {
+                reusable = &buffer;
+                break;
+            }
+            if (!reusable) {
+                reusable = &buffer;
+            }
+        }
+    }
+
+    if (!reusable && buffers.size() < maxBuffers) {
+        buffers.push_back(std::make_shared<std::vector<uint8_t>>());
+        reusable = &buffers.back();
+    }
+
+    if (!reusable) {
+        // Pool exhausted: hand out a one-off buffer that is freed normally
+        auto storage = std::make_shared<std::vector<uint8_t>>(size);
+        return std::shared_ptr<uint8_t>(storage, storage->data());
+    }
+
+    std::vector<uint8_t>& storage = **reusable;
+    if (storage.size() < size) {
+        storage.resize(size);
+    }
+    // Aliasing pointer: shares ownership of the pooled vector without another allocation
+    return std::shared_ptr<uint8_t>(*reusable, storage.data());
+}
+
+size_t BufferPool::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return buffers.size();
+}
@@ -0,0 +1,308 @@
+#include "EdgeDetector.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Canny edge detection for EdgeDetector::detectCanny.
+// Each band streams its rows once: grayscale conversion and border replication feed a
+// rolling 5-row window, the fused smoothing+Sobel pass produces int16 gx/gy and squared
+// magnitudes for a rolling 3-row window, and non-maximum suppression writes edge labels
+// straight to the output. Hysteresis then works in place on the output buffer.
+
+namespace {
+
+// Output labels before hysteresis; weak pixels become EDGE or 0
+constexpr uint8_t WEAK = 128;
+constexpr uint8_t EDGE = 255;
+
+// tan(22.5 degrees) in 15-bit fixed point, for direction sectors without atan2
+constexpr int64_t TAN_22_5 = 13573;
+
+// Binomial [1 2 1] smoothing convolved with Sobel's [1 2 1] smoothing and [-1 0 1]
+// difference gives a 5x5 gradient separable into [1 4 6 4 1] and [-1 -2 0 2 1].
+// |gx|, |gy| <= 255 * 16 * 6 = 24480, so gradients fit in int16, and the magnitudes
+// are 16x the Sobel magnitude of the blurred image.
+constexpr int64_t GRADIENT_SCALE = 16;
+
+// Pixels tested at once for the below-threshold fast path of suppression
+constexpr int SKIP_BLOCK = 16;
+
+struct BandScratch {
+    std::vector<uint8_t> gray;      // 5 rows of width + 4 (2 pixels of padding each side)
+    std::vector<int16_t> smoothed;  // Vertical passes of one row, width + 4
+    std::vector<int16_t> differenced;
+    std::vector<int16_t> gx, gy;    // 3 rows of width
+    std::vector<int32_t> magnitude; // 3 rows of width + 2, zero at both ends
+
+    explicit BandScratch(int width)
+        : gray(5 * (static_cast<size_t>(width) + 4)), smoothed(width + 4), differenced(width + 4),
+          gx(3 * static_cast<size_t>(width)), gy(3 * static_cast<size_t>(width)),
+          magnitude(3 * (static_cast<size_t>(width) + 2), 0) {}
+};
+
+class CannyBand {
+public:
+    CannyBand(const ImageView& image, uint8_t* output, size_t outputStride, int32_t lowSquared,
+              int32_t highSquared, LumaWeights luma)
+        : image(image), width(image.width), output(output), outputStride(outputStride),
+          lowSquared(lowSquared), highSquared(highSquared), luma(luma), scratch(image.width) {}
+
+    // Gradient, suppression and band-local hysteresis for rows [firstRow, lastRow)
+    void run(int firstRow, int lastRow) {
+        nextGrayRow = firstRow - 3;
+        computeGradientRow(firstRow - 1);
+        computeGradientRow(firstRow);
+        for (int y = firstRow; y < lastRow; ++y) {
+            computeGradientRow(y + 1);
+            suppressRow(y);
+        }
+
+        // Grow edges from strong pixels while the band is still in cache; links that
+        // cross band boundaries are resolved afterwards by traceSeams
+        std::vector<std::pair<int, int>> stack;
+        for (int y = firstRow; y < lastRow; ++y) {
+            uint8_t* row = output + static_cast<size_t>(y) * outputStride;
+            for (uint8_t* edge = row; (edge = findEdge(edge, row + width)) != row + width; ++edge) {
+                traceWeakEdges(output, outputStride, width, firstRow, lastRow, static_cast<int>(edge - row), y, stack);
+            }
+        }
+    }
+
+    // First strong pixel in [first, last), or last; memchr scans edge-free rows with SIMD
+    static uint8_t* findEdge(uint8_t* first, uint8_t* last) {
+        void* edge = std::memchr(first, EDGE, static_cast<size_t>(last - first));
+        return edge ? static_cast<uint8_t*>(edge) : last;
+    }
+
+    /**
+     * Promotes every weak pixel 8-connected to (x, y) within rows [firstRow, lastRow)
+     * @param stack Reused scratch for the depth-first search
+     */
+    static void traceWeakEdges(uint8_t* output, size_t outputStride, int width, int firstRow, int lastRow,
+                               int x, int y, std::vector<std::pair<int, int>>& stack) {
+        stack.emplace_back(x, y);
+        while (!stack.empty()) {
+            auto [cx, cy] = stack.back();
+            stack.pop_back();
+            for (int ny = std::max(cy - 1, firstRow); ny <= std::min(cy + 1, lastRow - 1); ++ny) {
+                uint8_t* row = output + static_cast<size_t>(ny) * outputStride;
+                for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, width - 1); ++nx) {
+                    if (row[nx] == WEAK) {
+                        row[nx] = EDGE;
+                        stack.emplace_back(nx, ny);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    const ImageView& image;
+    int width;
+    uint8_t* output;
+    size_t outputStride;
+    int32_t lowSquared, highSquared;
+    LumaWeights luma;
+    BandScratch scratch;
+    int nextGrayRow = 0;
+
+    uint8_t* grayRow(int y) {
+        return scratch.gray.data() + static_cast<size_t>((y % 5 + 5) % 5) * (width + 4);
+    }
+
+    int32_t* magnitudeRow(int y) {
+        return scratch.magnitude.data() + static_cast<size_t>((y % 3 + 3) % 3) * (width + 2);
+    }
+
+    // Converts rows up to y into the 5-row window, replicating the image border
+    void loadGrayRows(int y) {
+        for (; nextGrayRow <= y; ++nextGrayRow) {
+            uint8_t* padded = grayRow(nextGrayRow);
+            int sourceRow = std::min(std::max(nextGrayRow, 0), image.height - 1);
+            Image::convertToGrayscale(image.row(sourceRow), padded + 2, width, image.channels, luma);
+            padded[0] = padded[1] = padded[2];
+            padded[width + 3] = padded[width + 2] = padded[width + 1];
+        }
+    }
+
+    // Fused smoothing + Sobel for row y; rows outside the image have zero magnitude
+    void computeGradientRow(int y) {
+        int32_t* magnitude = magnitudeRow(y) + 1;
+        if (y < 0 || y >= image.height) {
+            std::fill(magnitude, magnitude + width, 0);
+            return;
+        }
+
+        loadGrayRows(y + 2);
+        size_t slot = static_cast<size_t>((y % 3 + 3) % 3) * width;
+        verticalPass(grayRow(y - 2), grayRow(y - 1), grayRow(y), grayRow(y + 1), grayRow(y + 2),
+                     scratch.smoothed.data(), scratch.differenced.data(), width + 4);
+        horizontalPass(scratch.smoothed.data(), scratch.differenced.data(), scratch.gx.data() + slot,
+                       scratch.gy.data() + slot, magnitude, width);
+    }
+
+    // Column sums of the 5-row window: [1 4 6 4 1] smoothing and [-1 -2 0 2 1] difference.
+    // The restrict-qualified pointers let the compiler vectorize without alias checks, and
+    // an AVX2 clone is picked at load time where supported.
+    __attribute__((target_clones("avx2", "default")))
+    static void verticalPass(const uint8_t* __restrict row0, const uint8_t* __restrict row1,
+                             const uint8_t* __restrict row2, const uint8_t* __restrict row3,
+                             const uint8_t* __restrict row4, int16_t* __restrict smoothed,
+                             int16_t* __restrict differenced, int count) {
+        for (int i = 0; i < count; ++i) {
+            smoothed[i] = static_cast<int16_t>(row0[i] + 4 * row1[i] + 6 * row2[i] + 4 * row3[i] + row4[i]);
+            differenced[i] = static_cast<int16_t>(row4[i] - row0[i] + 2 * (row3[i] - row1[i]));
+        }
+    }
+
+    // Row passes of the column sums: gx differences the smoothed sums, gy smooths the differences
+    __attribute__((target_clones("avx2", "default")))
+    static void horizontalPass(const int16_t* __restrict smoothed, const int16_t* __restrict differenced,
+                               int16_t* __restrict gx, int16_t* __restrict gy, int32_t* __restrict magnitude,
+                               int width) {
+        for (int x = 0; x < width; ++x) {
+            int sx = smoothed[x + 4] - smoothed[x] + 2 * (smoothed[x + 3] - smoothed[x + 1]);
+            int sy = differenced[x] + differenced[x + 4] + 4 * (differenced[x + 1] + differenced[x + 3]) +
+                     6 * differenced[x + 2];
+            gx[x] = static_cast<int16_t>(sx);
+            gy[x] = static_cast<int16_t>(sy);
+            magnitude[x] = sx * sx + sy * sy;
+        }
+    }
+
+    static bool anyAbove(const int32_t* magnitude, int32_t threshold) {
+        bool above = false;
+        for (int i = 0; i < SKIP_BLOCK; ++i) {
+            above |= magnitude[i] > threshold;
+        }
+        return above;
+    }
+
+    // Keeps local maxima across the edge, quantizing the gradient direction to 4 sectors
+    void suppressRow(int y) {
+        size_t slot = static_cast<size_t>((y % 3 + 3) % 3) * width;
+        const int16_t* gx = scratch.gx.data() + slot;
+        const int16_t* gy = scratch.gy.data() + slot;
+        const int32_t* above = magnitudeRow(y - 1) + 1;
+        const int32_t* center = magnitudeRow(y) + 1;
+        const int32_t* below = magnitudeRow(y + 1) + 1;
+        uint8_t* out = output + static_cast<size_t>(y) * outputStride;
+
+        for (int x = 0; x < width; ++x) {
+            // Most pixels are below the low threshold: skip them a vector at a time
+            if ((x & (SKIP_BLOCK - 1)) == 0 && x + SKIP_BLOCK <= width && !anyAbove(center + x, lowSquared)) {
+                std::memset(out + x, 0, SKIP_BLOCK);
+                x += SKIP_BLOCK - 1;
+                continue;
+            }
+
+            int32_t m = center[x];
+            if (m <= lowSquared) {
+                out[x] = 0;
+                continue;
+            }
+
+            int64_t ax = std::abs(gx[x]);
+            int64_t ay = std::abs(gy[x]) * (int64_t{1} << 15);
+            int64_t tan22 = ax * TAN_22_5;
+            int64_t tan67 = tan22 + ax * (int64_t{1} << 16);  // tan(67.5) = tan(22.5) + 2
+            bool isMaximum;
+            if (ay < tan22) {
+                isMaximum = m > center[x - 1] && m >= center[x + 1];
+            } else if (ay > tan67) {
+                isMaximum = m > above[x] && m >= below[x];
+            } else {
+                int step = (gx[x] ^ gy[x]) < 0 ? -1 : 1;
+                isMaximum = m > above[x - step] && m > below[x + step];
+            }
+            out[x] = !isMaximum ? 0 : m > highSquared ? EDGE : WEAK;
+        }
+    }
+};
+
+// Squared threshold in the units of the fused gradient; thresholds above the largest
+// possible magnitude (2 * 24480^2 < 2^31) saturate
+int32_t scaledSquare(int threshold) {
+    int64_t scaled = threshold * GRADIENT_SCALE;
+    return static_cast<int32_t>(std::min<int64_t>(scaled * scaled, INT32_MAX));
+}
+
+} // namespace
+
+Image EdgeDetector::detectCanny(const ImageView& image, const CannyOptions& options) {
+    validateDimensions(image.width, image.height, image.channels);
+    std::vector<uint8_t> resultData(static_cast<size_t>(image.width) * image.height);
+    detectCannyInto(image, resultData.data(), image.width, options);
+    return Image(std::move(resultData), image.width, image.height, 1);
+}
+
+void EdgeDetector::detectCannyInto(const ImageView& image, uint8_t* output, size_t outputStride,
+                                   const CannyOptions& options) {
+    if (options.lowThreshold < 0 || options.highThreshold < options.lowThreshold) {
+        throw std::invalid_argument("Canny thresholds must satisfy 0 <= low <= high, got low " +
+                                    std::to_string(options.lowThreshold) + ", high " +
+                                    std::to_string(options.highThreshold));
+    }
+    validateDimensions(image.width, image.height, image.channels);
+    validateBuffers(image, output, outputStride);
+
+    int width = image.width;
+    int height = image.height;
+    Profiler::Scope scope("canny", static_cast<size_t>(width) * height * (image.channels + 1));
+
+    ThreadPool* pool = options.threads == 1 ? nullptr : &ThreadPool::shared(options.threads);
+    int bandCount = pool ? std::min(height, static_cast<int>(pool->size()) * 4) : 1;
+    auto bandStart = [&](size_t band) {
+        return static_cast<int>(static_cast<long long>(height) * band / bandCount);
+    };
+    auto forEachBand = [&](const std::function<void(size_t)>& work) {
+        if (!pool) {
+            work(0);
+        } else {
+            pool->parallelFor(bandCount, work);
+        }
+    };
+
+    // Gradients, suppression and band-local hysteresis
+    int32_t lowSquared = scaledSquare(options.lowThreshold);
+    int32_t highSquared = scaledSquare(options.highThreshold);
+    forEachBand([&](size_t band) {
+        Profiler::Scope bandScope("canny_band");
+        CannyBand(image, output, outputStride, lowSquared, highSquared, options.luma).run(bandStart(band), bandStart(band + 1));
+    });
+
+    // Edges crossing a band boundary: grow from strong pixels on both sides of each
+    // seam without row limits. Every weak pixel still linked to an edge is reachable
+    // this way, since its chain must cross a seam next to an already promoted pixel.
+    {
+        Profiler::Scope seamScope("canny_seams");
+        std::vector<std::pair<int, int>> stack;
+        for (int band = 1; band < bandCount; ++band) {
+            int seam = bandStart(band);
+            for (int y = seam - 1; y <= seam; ++y) {
+                uint8_t* row = output + static_cast<size_t>(y) * outputStride;
+                for (uint8_t* edge = row; (edge = CannyBand::findEdge(edge, row + width)) != row + width; ++edge) {
+                    CannyBand::traceWeakEdges(output, outputStride, width, 0, height, static_cast<int>(edge - row), y,
+                                              stack);
+                }
+            }
+        }
+    }
+
+    // Weak pixels never reached from a strong one are not edges
+    forEachBand([&](size_t band) {
+        for (int y = bandStart(band); y < bandStart(band + 1); ++y) {
+            uint8_t* row = output + static_cast<size_t>(y) * outputStride;
+            for (int x = 0; x < width; ++x) {
+                row[x] = static_cast<uint8_t>((row[x] == EDGE) * EDGE);
+            }
+        }
+    });
+}
@@ -1,174 +1,558 @@
 #include "EdgeDetector.h"
-#include <cmath>
+#include "GradientKernels.h"
+#include "ThreadPool.h"
+#include "BufferPool.h"
+#include "PnmIO.h"
+#include "Profiler.h"
 #include <stdexcept>
 #include <algorithm>
+#include <atomic>
 #include <cctype>     
+#include <functional>
 
-// Sobel operators: Emphasize central pixels with weight 2
-// Better noise reduction compared to Prewitt operators
-const int EdgeDetector::SOBEL_X[3][3] = {
-    {-1, 0, 1},  // Detects vertical edges (horizontal gradient)
-    {-2, 0, 2},  // Central row has double weight
-    {-1, 0, 1}
-};
-const int EdgeDetector::SOBEL_Y[3][3] = {
-    {-1, -2, -1},
-    { 0,  0,  0},
-    { 1,  2,  1}
-};
-
-// Prewitt operators: Equal weight distribution
-// Simpler computation, slightly more noise sensitive
-const int EdgeDetector::PREWITT_X[3][3] = {
-    {-1, 0, 1},  // Detects vertical edges (horizontal gradient)  
-    {-1, 0, 1},  // Equal weights across rows
-    {-1, 0, 1}
-};
-const int EdgeDetector::PREWITT_Y[3][3] = {
-    {-1, -1, -1},
-    { 0,  0,  0},
-    { 1,  1,  1}
-};
-
-Image EdgeDetector::detectEdges(const Image& image, const std::string& operatorName) {
-
-    // Validate operator name first
-    std::string lowerOp = operatorName;
-    std::transform(lowerOp.begin(), lowerOp.end(), lowerOp.begin(), ::tolower);
-    if (lowerOp != "sobel" && lowerOp != "prewitt") {
-        throw std::invalid_argument("Unknown edge detection operator: " + operatorName + 
-                                  ". Supported operators: 'Sobel', 'Prewitt' (case-insensitive)");
-    }
-    
+Image EdgeDetector::detectEdges(const Image& image, const std::string& operatorName,
+                                const EdgeDetectionOptions& options) {
+    return detectEdges(image.view(), operatorName, options);
+}
+
+Image EdgeDetector::detectEdges(const ImageView& image, const std::string& operatorName,
+                                const EdgeDetectionOptions& options) {
+    // Validate operator name first; everything below runs on the resolved enum
+    return detectEdges(image, parseOperator(operatorName), options);
+}
+
+void EdgeDetector::detectEdgesInto(const ImageView& image, const std::string& operatorName,
+                                   uint8_t* output, size_t outputStride, Workspace& workspace,
+                                   const EdgeDetectionOptions& options) {
+    detectEdgesInto(image, parseOperator(operatorName), output, outputStride, workspace, options);
+}
+
+Image EdgeDetector::detectEdges(const ImageView& image, const std::string& operatorName,
+                                Workspace& workspace, BufferPool& pool,
+                                const EdgeDetectionOptions& options) {
+    return detectEdges(image, parseOperator(operatorName), workspace, pool, options);
+}
+
+Image EdgeDetector::detectEdges(const ImageView& image, EdgeOperator op, const EdgeDetectionOptions& options) {
+    return detectWithKernel(image, GradientKernels::rowKernel(op, options.norm), options);
+}
+
+void EdgeDetector::detectEdgesInto(const ImageView& image, EdgeOperator op, uint8_t* output, size_t outputStride,
+                                   Workspace& workspace, const EdgeDetectionOptions& options) {
+    detectIntoWithKernel(image, GradientKernels::rowKernel(op, options.norm), output, outputStride,
+                         workspace, options);
+}
+
+Image EdgeDetector::detectEdges(const ImageView& image, EdgeOperator op, Workspace& workspace, BufferPool& pool,
+                                const EdgeDetectionOptions& options) {
+    validateDimensions(image.width, image.height, image.channels);
+
+    std::shared_ptr<uint8_t> result = pool.acquire(static_cast<size_t>(image.width) * image.height);
+    detectIntoWithKernel(image, GradientKernels::rowKernel(op, options.norm), result.get(), image.width,
+                         workspace, options);
+    return Image(std::shared_ptr<const uint8_t>(std::move(result)), image.width, image.height, 1);
+}
+
+Image EdgeDetector::detectWithKernel(const ImageView& image, GradientKernels::RowKernel rowKernel,
+                                     const EdgeDetectionOptions& options) {
     // Validate image dimensions before processing
-    int width = image.getWidth();
-    int height = image.getHeight();
-    
+    int width = image.width;
+    int height = image.height;
+    validateDimensions(width, height, image.channels);
+
+    // The only full-size allocation: grayscale conversion and border padding are
+    // fused into the band loop, which keeps just three padded rows per band
+    std::vector<uint8_t> resultData(static_cast<size_t>(width) * height);
+    Workspace workspace;
+    detectIntoWithKernel(image, rowKernel, resultData.data(), width, workspace, options);
+
+    // Return a new Image object that takes over the edge data without copying
+    return Image(std::move(resultData), width, height, 1);
+}
+
+void EdgeDetector::detectIntoWithKernel(const ImageView& image, GradientKernels::RowKernel rowKernel,
+                                        uint8_t* output, size_t outputStride, Workspace& workspace,
+                                        const EdgeDetectionOptions& options) {
+    validateDimensions(image.width, image.height, image.channels);
+    validateBuffers(image, output, outputStride);
+    computeRows(image, Rect{0, 0, image.width, image.height}, rowKernel, options, output, outputStride, workspace);
+}
+
+std::vector<Image> EdgeDetector::detectEdgesInRegions(const ImageView& image, const std::string& operatorName,
+                                                      const std::vector<Rect>& regions,
+                                                      const EdgeDetectionOptions& options) {
+    GradientKernels::RowKernel rowKernel = GradientKernels::rowKernel(parseOperator(operatorName), options.norm);
+    validateDimensions(image.width, image.height, image.channels);
+    validateInput(image);
+    for (const Rect& region : regions) {
+        validateRegion(image, region);
+    }
+
+    // One workspace for all regions: it grows to the widest region and is reused
+    std::vector<Image> results;
+    results.reserve(regions.size());
+    Workspace workspace;
+    for (const Rect& region : regions) {
+        std::vector<uint8_t> edges(static_cast<size_t>(region.width) * region.height);
+        computeRows(image, region, rowKernel, options, edges.data(), region.width, workspace);
+        results.emplace_back(std::move(edges), region.width, region.height, 1);
+    }
+    return results;
+}
+
+void EdgeDetector::detectRegionInto(const ImageView& image, EdgeOperator op, const Rect& region, uint8_t* output,
+                                    size_t outputStride, Workspace& workspace, const EdgeDetectionOptions& options) {
+    validateDimensions(image.width, image.height, image.channels);
+    validateInput(image);
+    validateRegion(image, region);
+    if (!output || outputStride < static_cast<size_t>(region.width)) {
+        throw std::invalid_argument("Invalid output buffer. Expected row size: " + std::to_string(region.width) +
+                                    ", Actual stride: " + std::to_string(outputStride));
+    }
+    computeRows(image, region, GradientKernels::rowKernel(op, options.norm), options, output, outputStride,
+                workspace);
+}
+
+void EdgeDetector::detectEdgesStreaming(ScanlineReader& reader, ScanlineWriter& writer,
+                                        const std::string& operatorName,
+                                        const EdgeDetectionOptions& options, int stripRows) {
+    GradientKernels::RowKernel rowKernel = GradientKernels::rowKernel(parseOperator(operatorName), options.norm);
+
+    int width = reader.getWidth();
+    int height = reader.getHeight();
+    int channels = reader.getChannels();
+    validateDimensions(width, height, channels);
+
+    if (writer.getWidth() != width || writer.getHeight() != height || writer.getChannels() != 1) {
+        throw std::invalid_argument("Streaming output must be a single-channel image of the input size");
+    }
+    if (stripRows < 1) {
+        throw std::invalid_argument("Strip height must be at least 1 row");
+    }
+
+    // Input strip plus one halo row on each side, and one output strip: O(width) memory
+    size_t rowSize = static_cast<size_t>(width) * channels;
+    std::vector<uint8_t> input((static_cast<size_t>(stripRows) + 2) * rowSize);
+    std::vector<uint8_t> output(static_cast<size_t>(stripRows) * width);
+
+    Workspace workspace;
+    int bufferStart = 0;                          // Image row held in input row 0
+    int bufferedRows = std::min(stripRows + 1, height);
+    {
+        Profiler::Scope readScope("read", static_cast<size_t>(bufferedRows) * rowSize);
+        reader.readRows(input.data(), bufferedRows);
+    }
+
+    for (int stripStart = 0; stripStart < height; stripStart += stripRows) {
+        int stripEnd = std::min(stripStart + stripRows, height);
+
+        // The view ends exactly where the image ends, so clamping at its top and
+        // bottom edges reproduces border replication; elsewhere the halo rows are real
+        ImageView strip{input.data(), width, bufferedRows, channels, rowSize};
+        computeRows(strip, Rect{0, stripStart - bufferStart, width, stripEnd - stripStart}, rowKernel, options,
+                    output.data(), width, workspace);
+        {
+            Profiler::Scope writeScope("write", static_cast<size_t>(stripEnd - stripStart) * width);
+            writer.writeRows(output.data(), stripEnd - stripStart);
+        }
+
+        if (stripEnd == height) {
+            break;
+        }
+
+        // Keep the last output row and its halo below for the next strip, then refill
+        int keepFrom = stripEnd - 1;
+        int keptRows = bufferStart + bufferedRows - keepFrom;
+        std::copy(input.begin() + static_cast<size_t>(keepFrom - bufferStart) * rowSize,
+                  input.begin() + static_cast<size_t>(bufferedRows) * rowSize, input.begin());
+        bufferStart = keepFrom;
+
+        int newRows = std::min(stripRows, height - (bufferStart + keptRows));
+        Profiler::Scope readScope("read", static_cast<size_t>(newRows) * rowSize);
+        reader.readRows(input.data() + static_cast<size_t>(keptRows) * rowSize, newRows);
+        bufferedRows = keptRows + newRows;
+    }
+
+    writer.finish();
+}
+
+void EdgeDetector::validateDimensions(int width, int height, int channels) {
     if (width < 3 || height < 3) {
         throw std::runtime_error("Image too small for edge detection. Minimum size: 3x3, "
                                 "Actual size: " + std::to_string(width) + "x" + std::to_string(height));
     }
-    
+
+    // Edge detection works on grayscale images; conversion happens row by row
+    if (channels != 1 && channels != 3 && channels != 4) {
+        throw std::runtime_error("Grayscale conversion only supports RGB (3 channels) or RGBA (4 channels). "
+                                "Current channels: " + std::to_string(channels));
+    }
+}
+
+void EdgeDetector::validateInput(const ImageView& image) {
     // Validate image data integrity
-    const std::vector<uint8_t>& originalData = image.getData();
-    size_t expectedSize = static_cast<size_t>(width) * height * image.getChannels();
-    if (originalData.empty() || originalData.size() != expectedSize) {
-        throw std::runtime_error("Invalid image data. Expected size: " + std::to_string(expectedSize) + 
-                                ", Actual size: " + std::to_string(originalData.size()));
+    size_t rowSize = static_cast<size_t>(image.width) * image.channels;
+    if (!image.data || image.stride < rowSize) {
+        throw std::runtime_error("Invalid image data. Expected row size: " + std::to_string(rowSize) + 
+                                ", Actual stride: " + std::to_string(image.stride));
     }
+}
 
-    // Edge detection works on grayscale images.
-    Image grayImage = image.toGrayscale();
+void EdgeDetector::validateBuffers(const ImageView& image, const uint8_t* output, size_t outputStride) {
+    validateInput(image);
 
-    const std::vector<uint8_t>& imageData = grayImage.getData();
+    if (!output || outputStride < static_cast<size_t>(image.width)) {
+        throw std::invalid_argument("Invalid output buffer. Expected row size: " + std::to_string(image.width) +
+                                    ", Actual stride: " + std::to_string(outputStride));
+    }
+}
 
-    // Select the appropriate kernels based on the operator name.
-    const int (*kernelX)[3];
-    const int (*kernelY)[3];
+void EdgeDetector::validateRegion(const ImageView& image, const Rect& region) {
+    if (region.width < 1 || region.height < 1 || region.x < 0 || region.y < 0 ||
+        region.width > image.width - region.x || region.height > image.height - region.y) {
+        throw std::invalid_argument("Region " + std::to_string(region.width) + "x" + std::to_string(region.height) +
+                                    "+" + std::to_string(region.x) + "+" + std::to_string(region.y) +
+                                    " is empty or outside the " + std::to_string(image.width) + "x" +
+                                    std::to_string(image.height) + " image");
+    }
+}
 
-    if (lowerOp == "sobel") {
-        kernelX = SOBEL_X;
-        kernelY = SOBEL_Y;
-    } else {
-        kernelX = PREWITT_X;
-        kernelY = PREWITT_Y;
-    } 
+template <typename BandFunction>
+void EdgeDetector::forEachBand(const ImageView& image, const Rect& region, const EdgeDetectionOptions& options,
+                               Workspace& workspace, bool gradientScratch, BandFunction& processBand) {
+    ThreadPool* pool = options.threads == 1 ? nullptr : &ThreadPool::shared(options.threads);
+    bool tiled = options.tiles.tiled();
+    int tileWidth = options.tiles.width > 0 ? std::min(options.tiles.width, region.width) : region.width;
+    int tileHeight = options.tiles.height > 0 ? std::min(options.tiles.height, region.height) : region.height;
+    int tileColumns = (region.width + tileWidth - 1) / tileWidth;
+    size_t tileCount = static_cast<size_t>(tileColumns) * ((region.height + tileHeight - 1) / tileHeight);
 
-    // Create padded image
-    std::vector<uint8_t> paddedData = createPaddedImage(imageData, width, height, 1);
-    int paddedWidth = width + 2;
-    
-    // Apply edge detection on padded image
-    std::vector<uint8_t> resultData(width * height);
-    
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            // Coordinates in padded image (offset by 1)
-            int paddedX = x + 1;
-            int paddedY = y + 1;
-            
-            // Apply kernels
-            int gx = applyKernel(paddedData, paddedWidth, paddedX, paddedY, kernelX);
-            int gy = applyKernel(paddedData, paddedWidth, paddedX, paddedY, kernelY);
-            
-            // Calculate magnitude and store in original coordinates
-            uint8_t magnitude = calculateMagnitude(gx, gy);
-            resultData[y * width + x] = magnitude;
+    // Bands: several per thread keep cores busy when bands finish unevenly, each with its
+    // own scratch. Tiles: one scratch slot per worker, which claims tiles until none are left
+    size_t unitCount = tiled ? tileCount
+                             : pool ? std::min<size_t>(region.height, pool->size() * 4) : 1;
+    size_t slotCount = tiled ? (pool ? std::min<size_t>(tileCount, pool->size()) : 1) : unitCount;
+
+    // One rolling window (and optionally a gx/gy row pair) per slot, carved out of the workspace
+    size_t windowSize = 3 * (static_cast<size_t>(tileWidth) + 2);
+    if (workspace.rowWindows.size() < windowSize * slotCount) {
+        workspace.rowWindows.resize(windowSize * slotCount);
+    }
+    size_t gradientSize = gradientScratch ? 2 * static_cast<size_t>(tileWidth) : 0;
+    if (workspace.gradientRows.size() < gradientSize * slotCount) {
+        workspace.gradientRows.resize(gradientSize * slotCount);
+    }
+    uint8_t* windows = workspace.rowWindows.data();
+    int16_t* gradientRows = workspace.gradientRows.data();
+
+    auto runUnit = [&](const Rect& band, size_t slot) {
+        Profiler::Scope bandScope(tiled ? "detect_tile" : "detect_band",
+                                  static_cast<size_t>(band.height) * band.width * (image.channels + 1));
+        processBand(band, windows + slot * windowSize, gradientScratch ? gradientRows + slot * gradientSize : nullptr);
+    };
+    std::atomic<size_t> nextTile{0};
+    auto runSlot = [&](size_t slot) {
+        if (!tiled) {
+            int bandFirst = static_cast<int>(static_cast<long long>(region.height) * slot / unitCount);
+            int bandLast = static_cast<int>(static_cast<long long>(region.height) * (slot + 1) / unitCount);
+            runUnit(Rect{region.x, region.y + bandFirst, region.width, bandLast - bandFirst}, slot);
+            return;
+        }
+        for (size_t tile; (tile = nextTile.fetch_add(1, std::memory_order_relaxed)) < tileCount;) {
+            int x = static_cast<int>(tile % tileColumns) * tileWidth;
+            int y = static_cast<int>(tile / tileColumns) * tileHeight;
+            runUnit(Rect{region.x + x, region.y + y, std::min(tileWidth, region.width - x),
+                         std::min(tileHeight, region.height - y)}, slot);
+        }
+    };
+
+    if (!pool || slotCount == 1) {
+        for (size_t slot = 0; slot < slotCount; ++slot) {
+            runSlot(slot);
         }
+    } else {
+        // std::ref keeps std::function from copying the closure to the heap
+        pool->parallelFor(slotCount, std::ref(runSlot));
     }
+}
 
-    // Return a new Image object with the edge data.
-    return Image(resultData, width, height, 1);
+void EdgeDetector::computeRows(const ImageView& image, const Rect& region,
+                               GradientKernels::RowKernel rowKernel, const EdgeDetectionOptions& options,
+                               uint8_t* output, size_t outputStride, Workspace& workspace) {
+    Profiler::Scope scope("detect", static_cast<size_t>(region.height) * region.width * (image.channels + 1));
+
+    auto processBand = [&](const Rect& band, uint8_t* window, int16_t*) {
+        processRows(image, band, rowKernel, window,
+                    output + static_cast<size_t>(band.y - region.y) * outputStride + (band.x - region.x),
+                    outputStride, options.luma);
+    };
+    forEachBand(image, region, options, workspace, false, processBand);
 }
 
-// Border replication padding: Extends edge pixels to handle boundary conditions
-// Alternative approaches: zero-padding, mirror-padding, wrap-around
-std::vector<uint8_t> EdgeDetector::createPaddedImage(const std::vector<uint8_t>& originalData,
-                                                     int width, int height, int padSize) {
-    int paddedWidth = width + 2 * padSize;
-    int paddedHeight = height + 2 * padSize;
-    std::vector<uint8_t> paddedData(paddedWidth * paddedHeight);
-
-    // Copy original image to center of padded image
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            int originalIndex = y * width + x;
-            int paddedIndex = (y + padSize) * paddedWidth + (x + padSize);
-            paddedData[paddedIndex] = originalData[originalIndex];
+void EdgeDetector::detectGradientsInto(const ImageView& image, EdgeOperator op, const GradientPlanes& planes,
+                                       Workspace& workspace, const EdgeDetectionOptions& options) {
+    GradientKernels::PlaneRowKernel rowKernel = GradientKernels::planeRowKernel(op, options.norm);
+    validateDimensions(image.width, image.height, image.channels);
+    validateBuffers(image, planes.magnitude, planes.magnitudeStride);
+
+    size_t width = static_cast<size_t>(image.width);
+    if ((planes.gx || planes.gy) && planes.gradientStride < width) {
+        throw std::invalid_argument("Invalid gradient planes. Expected row size: " + std::to_string(width) +
+                                    ", Actual stride: " + std::to_string(planes.gradientStride));
+    }
+    if (planes.orientation && planes.orientationStride < width) {
+        throw std::invalid_argument("Invalid orientation plane. Expected row size: " + std::to_string(width) +
+                                    ", Actual stride: " + std::to_string(planes.orientationStride));
+    }
+    if (planes.orientation && planes.orientationBins != 4 && planes.orientationBins != 8) {
+        throw std::invalid_argument("Orientation bins must be 4 or 8, got " +
+                                    std::to_string(planes.orientationBins));
+    }
+
+    // Bytes read plus the bytes of every plane written
+    size_t pixels = width * image.height;
+    size_t planeBytes = 1 + (planes.gx ? 2 : 0) + (planes.gy ? 2 : 0) + (planes.orientation ? 1 : 0);
+    Profiler::Scope scope("detect", pixels * (image.channels + planeBytes));
+
+    auto processBand = [&](const Rect& band, uint8_t* window, int16_t* gradientRows) {
+        GradientPlanes bandPlanes = planes;
+        bandPlanes.magnitude += band.y * planes.magnitudeStride + band.x;
+        if (bandPlanes.gx) {
+            bandPlanes.gx += band.y * planes.gradientStride + band.x;
+        }
+        if (bandPlanes.gy) {
+            bandPlanes.gy += band.y * planes.gradientStride + band.x;
+        }
+        if (bandPlanes.orientation) {
+            bandPlanes.orientation += band.y * planes.orientationStride + band.x;
         }
+        processGradientRows(image, band, rowKernel, window, bandPlanes, gradientRows, options.luma);
+    };
+    forEachBand(image, Rect{0, 0, image.width, image.height}, options, workspace, !planes.gx || !planes.gy,
+                processBand);
+}
+
+std::vector<Image> EdgeDetector::detectEdgesMulti(const ImageView& image, const std::vector<std::string>& operatorNames,
+                                                  const EdgeDetectionOptions& options) {
+    std::vector<EdgeOperator> ops;
+    for (const std::string& name : operatorNames) {
+        ops.push_back(parseOperator(name));
+    }
+    validateDimensions(image.width, image.height, image.channels);
+
+    size_t pixels = static_cast<size_t>(image.width) * image.height;
+    std::vector<std::vector<uint8_t>> planes(ops.size(), std::vector<uint8_t>(pixels));
+    std::vector<uint8_t*> outputs;
+    for (auto& plane : planes) {
+        outputs.push_back(plane.data());
     }
+    Workspace workspace;
+    detectEdgesMultiInto(image, ops, outputs.data(), image.width, workspace, options);
 
-    // Replicate top and bottom borders
-    for (int y = 0; y < padSize; ++y) {
-        for (int x = padSize; x < paddedWidth - padSize; ++x) {
-            // Top border: replicate first row
-            paddedData[y * paddedWidth + x] = 
-                paddedData[padSize * paddedWidth + x];
-            
-            // Bottom border: replicate last row
-            paddedData[(paddedHeight - 1 - y) * paddedWidth + x] = 
-                paddedData[(paddedHeight - 1 - padSize) * paddedWidth + x];
+    std::vector<Image> results;
+    results.reserve(planes.size());
+    for (auto& plane : planes) {
+        results.emplace_back(std::move(plane), image.width, image.height, 1);
+    }
+    return results;
+}
+
+void EdgeDetector::detectEdgesMultiInto(const ImageView& image, const std::vector<EdgeOperator>& ops,
+                                        uint8_t* const* outputs, size_t outputStride, Workspace& workspace,
+                                        const EdgeDetectionOptions& options) {
+    if (ops.empty()) {
+        throw std::invalid_argument("Multi-operator detection needs at least one operator");
+    }
+    validateDimensions(image.width, image.height, image.channels);
+
+    // The kernel writes the planes indexed by operator, so each operator may appear once
+    unsigned operators = 0;
+    uint8_t* planes[3] = {};
+    for (size_t i = 0; i < ops.size(); ++i) {
+        unsigned bit = GradientKernels::operatorBit(ops[i]);
+        if (operators & bit) {
+            throw std::invalid_argument("Operator " + std::to_string(i + 1) + " of " + std::to_string(ops.size()) +
+                                        " repeats an earlier one");
         }
+        validateBuffers(image, outputs[i], outputStride);
+        operators |= bit;
+        planes[static_cast<int>(ops[i])] = outputs[i];
     }
-    
-    // Replicate left and right borders
-    for (int y = 0; y < paddedHeight; ++y) {
-        for (int x = 0; x < padSize; ++x) {
-            // Left border: replicate first column
-            paddedData[y * paddedWidth + x] = 
-                paddedData[y * paddedWidth + padSize];
-            
-            // Right border: replicate last column
-            paddedData[y * paddedWidth + (paddedWidth - 1 - x)] = 
-                paddedData[y * paddedWidth + (paddedWidth - 1 - padSize)];
+    GradientKernels::MultiRowKernel rowKernel = GradientKernels::multiRowKernel(operators, options.norm);
+
+    // Bytes read plus one byte per operator written
+    Profiler::Scope scope("detect", static_cast<size_t>(image.width) * image.height * (image.channels + ops.size()));
+
+    auto processBand = [&](const Rect& band, uint8_t* window, int16_t*) {
+        uint8_t* bandOutputs[3];
+        for (int op = 0; op < 3; ++op) {
+            bandOutputs[op] = planes[op] ? planes[op] + band.y * outputStride + band.x : nullptr;
         }
+        processMultiRows(image, band, rowKernel, window, bandOutputs, outputStride, options.luma);
+    };
+    forEachBand(image, Rect{0, 0, image.width, image.height}, options, workspace, false, processBand);
+}
+
+GradientField EdgeDetector::detectGradients(const ImageView& image, const std::string& operatorName,
+                                            int orientationBins, const EdgeDetectionOptions& options) {
+    EdgeOperator op = parseOperator(operatorName);
+    validateDimensions(image.width, image.height, image.channels);
+
+    size_t pixels = static_cast<size_t>(image.width) * image.height;
+    std::vector<uint8_t> magnitude(pixels);
+    std::vector<uint8_t> orientation(pixels);
+    std::vector<int16_t> gx(pixels);
+    std::vector<int16_t> gy(pixels);
+
+    GradientPlanes planes;
+    planes.magnitude = magnitude.data();
+    planes.magnitudeStride = image.width;
+    planes.gx = gx.data();
+    planes.gy = gy.data();
+    planes.gradientStride = image.width;
+    planes.orientation = orientation.data();
+    planes.orientationStride = image.width;
+    planes.orientationBins = orientationBins;
+
+    Workspace workspace;
+    detectGradientsInto(image, op, planes, workspace, options);
+
+    return GradientField{Image(std::move(magnitude), image.width, image.height, 1), std::move(gx), std::move(gy),
+                         Image(std::move(orientation), image.width, image.height, 1)};
+}
+
+EdgeOperator EdgeDetector::parseOperator(const std::string& operatorName) {
+    std::string lowerOp = operatorName;
+    std::transform(lowerOp.begin(), lowerOp.end(), lowerOp.begin(), ::tolower);
+    if (lowerOp == "sobel") {
+        return EdgeOperator::Sobel;
+    }
+    if (lowerOp == "prewitt") {
+        return EdgeOperator::Prewitt;
+    }
+    if (lowerOp == "scharr") {
+        return EdgeOperator::Scharr;
+    }
+    throw std::invalid_argument("Unknown edge detection operator: " + operatorName + 
+                              ". Supported operators: 'Sobel', 'Prewitt', 'Scharr' (case-insensitive)");
+}
+
+void EdgeDetector::validateOperator(const std::string& operatorName) {
+    parseOperator(operatorName);
+}
+
+GradientNorm EdgeDetector::parseNorm(const std::string& name) {
+    std::string lowerName = name;
+    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+    if (lowerName == "l2") {
+        return GradientNorm::L2;
+    }
+    if (lowerName == "l1") {
+        return GradientNorm::L1;
     }
+    if (lowerName == "linf") {
+        return GradientNorm::LInf;
+    }
+    throw std::invalid_argument("Unknown gradient norm: " + name +
+                                ". Supported norms: 'L2', 'L1', 'Linf' (case-insensitive)");
+}
+
+// Border replication padding: Extends edge pixels to handle boundary conditions
+// Row indices are clamped into the image and the converted row is widened by one
+// pixel on each side, which is equivalent to a fully padded copy. Inside the image
+// that pixel is the real neighbour, so regions see the same values as a full frame.
+void EdgeDetector::loadPaddedRow(const ImageView& image, int y, int firstColumn, int columns, uint8_t* paddedRow,
+                                 LumaWeights luma) {
+    int sourceRow = std::min(std::max(y, 0), image.height - 1);
+    int haloLeft = firstColumn > 0 ? 1 : 0;
+    int haloRight = firstColumn + columns < image.width ? 1 : 0;
+
+    const uint8_t* source = image.row(sourceRow) + static_cast<size_t>(firstColumn - haloLeft) * image.channels;
+    Image::convertToGrayscale(source, paddedRow + 1 - haloLeft, columns + haloLeft + haloRight, image.channels,
+                              luma);
+    if (!haloLeft) {
+        paddedRow[0] = paddedRow[1];
+    }
+    if (!haloRight) {
+        paddedRow[columns + 1] = paddedRow[columns];
+    }
+}
 
-    return paddedData;
+// Rolling 3-row window: each source row is converted once per band (plus a 1-row
+// halo above and below), and output rows are written straight to the result
+void EdgeDetector::processRows(const ImageView& image, const Rect& band,
+                               GradientKernels::RowKernel rowKernel,
+                               uint8_t* window, uint8_t* output, size_t outputStride, LumaWeights luma) {
+    int width = band.width;
+    int paddedWidth = width + 2;
+    uint8_t* above = window;
+    uint8_t* center = above + paddedWidth;
+    uint8_t* below = center + paddedWidth;
+
+    loadPaddedRow(image, band.y - 1, band.x, width, above, luma);
+    loadPaddedRow(image, band.y, band.x, width, center, luma);
+
+    for (int y = band.y; y < band.y + band.height; ++y) {
+        loadPaddedRow(image, y + 1, band.x, width, below, luma);
+        rowKernel(above, center, below, output, width);
+        output += outputStride;
+
+        // Slide the window down one row, recycling the oldest buffer
+        std::swap(above, center);
+        std::swap(center, below);
+    }
 }
 
-// Multiply each pixel by corresponding kernel value and sum
-// Result represents gradient strength in kernel direction
-int EdgeDetector::applyKernel(
-    const std::vector<uint8_t>& imageData,
-    int width,
-    int x,
-    int y,
-    const int kernel[3][3]
-) {
-    int sum = 0;
-    for (int ky = -1; ky <= 1; ++ky) {
-        for (int kx = -1; kx <= 1; ++kx) {
-            uint8_t pixelValue = imageData[(y + ky) * width + (x + kx)];
-            sum += pixelValue * kernel[ky + 1][kx + 1];
+void EdgeDetector::processMultiRows(const ImageView& image, const Rect& band,
+                                    GradientKernels::MultiRowKernel rowKernel, uint8_t* window,
+                                    uint8_t* const* outputs, size_t outputStride, LumaWeights luma) {
+    int width = band.width;
+    int paddedWidth = width + 2;
+    uint8_t* above = window;
+    uint8_t* center = above + paddedWidth;
+    uint8_t* below = center + paddedWidth;
+
+    loadPaddedRow(image, band.y - 1, band.x, width, above, luma);
+    loadPaddedRow(image, band.y, band.x, width, center, luma);
+
+    uint8_t* rows[3];
+    for (int y = 0; y < band.height; ++y) {
+        loadPaddedRow(image, band.y + y + 1, band.x, width, below, luma);
+        for (int op = 0; op < 3; ++op) {
+            rows[op] = outputs[op] ? outputs[op] + y * outputStride : nullptr;
         }
+        rowKernel(above, center, below, rows, width);
+
+        std::swap(above, center);
+        std::swap(center, below);
     }
-    return sum;
 }
 
-// Euclidean norm: sqrt(gx² + gy²) gives gradient magnitude
-// Represents edge strength regardless of direction
-uint8_t EdgeDetector::calculateMagnitude(int gx, int gy) {
-    double magnitude = std::sqrt(static_cast<double>(gx) * gx + static_cast<double>(gy) * gy);
-    return static_cast<uint8_t>(std::min(255.0, magnitude));
-}
\ No newline at end of file
+void EdgeDetector::processGradientRows(const ImageView& image, const Rect& band,
+                                       GradientKernels::PlaneRowKernel rowKernel, uint8_t* window,
+                                       const GradientPlanes& planes, int16_t* gradientRows, LumaWeights luma) {
+    int width = band.width;
+    int paddedWidth = width + 2;
+    uint8_t* above = window;
+    uint8_t* center = above + paddedWidth;
+    uint8_t* below = center + paddedWidth;
+
+    loadPaddedRow(image, band.y - 1, band.x, width, above, luma);
+    loadPaddedRow(image, band.y, band.x, width, center, luma);
+
+    for (int y = 0; y < band.height; ++y) {
+        loadPaddedRow(image, band.y + y + 1, band.x, width, below, luma);
+
+        // Planes that are not stored still receive the row, in scratch, for the orientation
+        int16_t* gx = planes.gx ? planes.gx + y * planes.gradientStride : gradientRows;
+        int16_t* gy = planes.gy ? planes.gy + y * planes.gradientStride : gradientRows + width;
+        rowKernel(above, center, below, planes.magnitude + y * planes.magnitudeStride, gx, gy, width);
+        if (planes.orientation) {
+            GradientKernels::orientationRow(gx, gy, planes.orientation + y * planes.orientationStride, width,
+                                            planes.orientationBins);
+        }
+
+        std::swap(above, center);
+        std::swap(center, below);
+    }
+}
@@ -0,0 +1,225 @@
+#include "EdgePipeline.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+
+// Smoothing stages use the row kernel signature of the gradients: three padded rows in,
+// one row of width values out
+
+void boxRow(const uint8_t* above, const uint8_t* center, const uint8_t* below, uint8_t* output, int width) {
+    for (int x = 0; x < width; ++x) {
+        int sum = above[x] + above[x + 1] + above[x + 2] + center[x] + center[x + 1] + center[x + 2] +
+                  below[x] + below[x + 1] + below[x + 2];
+        output[x] = static_cast<uint8_t>((sum + 4) / 9);
+    }
+}
+
+void gaussianRow(const uint8_t* above, const uint8_t* center, const uint8_t* below, uint8_t* output, int width) {
+    for (int x = 0; x < width; ++x) {
+        int sum = (above[x] + 2 * above[x + 1] + above[x + 2]) + 2 * (center[x] + 2 * center[x + 1] + center[x + 2]) +
+                  (below[x] + 2 * below[x + 1] + below[x + 2]);
+        output[x] = static_cast<uint8_t>((sum + 8) >> 4);
+    }
+}
+
+} // namespace
+
+EdgePipeline& EdgePipeline::grayscale(LumaWeights weights) {
+    if (!stages.empty()) {
+        throw std::invalid_argument("Grayscale conversion must be the first pipeline stage");
+    }
+    luma = weights;
+    return *this;
+}
+
+EdgePipeline& EdgePipeline::blur(BlurKernel kernel) {
+    Stage stage;
+    stage.rowKernel = kernel == BlurKernel::Box ? boxRow : gaussianRow;
+    stages.push_back(stage);
+    return *this;
+}
+
+EdgePipeline& EdgePipeline::gradient(EdgeOperator op, GradientNorm norm) {
+    Stage stage;
+    stage.rowKernel = GradientKernels::rowKernel(op, norm);
+    stages.push_back(stage);
+    return *this;
+}
+
+EdgePipeline& EdgePipeline::threshold(int level) {
+    if (level < 0 || level > 255) {
+        throw std::invalid_argument("Threshold must be in [0, 255], got " + std::to_string(level));
+    }
+    std::array<uint8_t, 256> table;
+    for (int value = 0; value < 256; ++value) {
+        table[value] = value >= level ? 255 : 0;
+    }
+    appendTable(table);
+    return *this;
+}
+
+EdgePipeline& EdgePipeline::normalize(int low, int high) {
+    if (low < 0 || high > 255 || low >= high) {
+        throw std::invalid_argument("Normalization range must satisfy 0 <= low < high <= 255, got [" +
+                                    std::to_string(low) + ", " + std::to_string(high) + "]");
+    }
+    std::array<uint8_t, 256> table;
+    int range = high - low;
+    for (int value = 0; value < 256; ++value) {
+        int clamped = std::min(std::max(value, low), high);
+        table[value] = static_cast<uint8_t>(((clamped - low) * 255 + range / 2) / range);
+    }
+    appendTable(table);
+    return *this;
+}
+
+void EdgePipeline::appendTable(const std::array<uint8_t, 256>& table) {
+    if (!stages.empty() && !stages.back().rowKernel) {
+        for (uint8_t& value : stages.back().table) {
+            value = table[value];
+        }
+        return;
+    }
+    Stage stage;
+    stage.table = table;
+    stages.push_back(stage);
+}
+
+int EdgePipeline::halo() const {
+    return static_cast<int>(std::count_if(stages.begin(), stages.end(),
+                                          [](const Stage& stage) { return stage.rowKernel != nullptr; }));
+}
+
+Image EdgePipeline::run(const ImageView& image, const PipelineOptions& options) const {
+    std::vector<uint8_t> result(static_cast<size_t>(std::max(image.width, 0)) * std::max(image.height, 0));
+    runInto(image, result.data(), image.width, options);
+    return Image(std::move(result), image.width, image.height, 1);
+}
+
+void EdgePipeline::runInto(const ImageView& image, uint8_t* output, size_t outputStride,
+                           const PipelineOptions& options) const {
+    size_t rowSize = static_cast<size_t>(std::max(image.width, 0)) * image.channels;
+    if (!image.data || image.width < 1 || image.height < 1 || image.stride < rowSize) {
+        throw std::runtime_error("Invalid image data. Size: " + std::to_string(image.width) + "x" +
+                                 std::to_string(image.height) + ", Expected row size: " + std::to_string(rowSize) +
+                                 ", Actual stride: " + std::to_string(image.stride));
+    }
+    if (image.channels != 1 && image.channels != 3 && image.channels != 4) {
+        throw std::runtime_error("Grayscale conversion only supports RGB (3 channels) or RGBA (4 channels). "
+                                 "Current channels: " + std::to_string(image.channels));
+    }
+    if (!output || outputStride < static_cast<size_t>(image.width)) {
+        throw std::invalid_argument("Invalid output buffer. Expected row size: " + std::to_string(image.width) +
+                                    ", Actual stride: " + std::to_string(outputStride));
+    }
+
+    int margin = halo();
+    int tileWidth = options.tiles.width > 0 ? std::min(options.tiles.width, image.width) : image.width;
+    int tileHeight = options.tiles.height > 0 ? std::min(options.tiles.height, image.height) : image.height;
+    int tileColumns = (image.width + tileWidth - 1) / tileWidth;
+    size_t tileCount = static_cast<size_t>(tileColumns) * ((image.height + tileHeight - 1) / tileHeight);
+
+    // Two buffers per worker hold the tile grown by the remaining halo, alternating
+    // between the input and the output of each neighbourhood stage
+    ThreadPool* pool = options.threads == 1 ? nullptr : &ThreadPool::shared(options.threads);
+    size_t workers = pool ? std::min<size_t>(tileCount, pool->size()) : 1;
+    size_t bufferSize = static_cast<size_t>(tileWidth + 2 * margin) * (tileHeight + 2 * margin);
+    std::vector<uint8_t> scratch(2 * bufferSize * workers);
+
+    Profiler::Scope scope("pipeline", static_cast<size_t>(image.width) * image.height * (image.channels + 1));
+    std::atomic<size_t> nextTile{0};
+    auto runWorker = [&](size_t worker) {
+        uint8_t* buffers[2] = {scratch.data() + 2 * worker * bufferSize, scratch.data() + (2 * worker + 1) * bufferSize};
+        for (size_t index; (index = nextTile.fetch_add(1, std::memory_order_relaxed)) < tileCount;) {
+            int x = static_cast<int>(index % tileColumns) * tileWidth;
+            int y = static_cast<int>(index / tileColumns) * tileHeight;
+            Rect tile{x, y, std::min(tileWidth, image.width - x), std::min(tileHeight, image.height - y)};
+            processTile(image, tile, buffers, output + static_cast<size_t>(y) * outputStride + x, outputStride);
+        }
+    };
+
+    if (workers == 1) {
+        runWorker(0);
+    } else {
+        // std::ref keeps std::function from copying the closure to the heap
+        pool->parallelFor(workers, std::ref(runWorker));
+    }
+}
+
+// Each stage's buffer covers the tile grown by the halo of the stages after it. Pixels
+// of that area outside the image replicate the stage's border values, which is the
+// padding the next stage would see when the stages run on whole images one by one
+void EdgePipeline::processTile(const ImageView& image, const Rect& tile, uint8_t* buffers[2], uint8_t* output,
+                               size_t outputStride) const {
+    int margin = halo();
+    int stride = tile.width + 2 * margin;
+    int originX = tile.x - margin;
+    int originY = tile.y - margin;
+    auto at = [&](uint8_t* buffer, int x, int y) {
+        return buffer + static_cast<size_t>(y - originY) * stride + (x - originX);
+    };
+
+    // Part of the tile grown by m that lies inside the image
+    auto inside = [&](int m) {
+        int left = std::max(0, tile.x - m);
+        int top = std::max(0, tile.y - m);
+        return Rect{left, top, std::min(image.width, tile.x + tile.width + m) - left,
+                    std::min(image.height, tile.y + tile.height + m) - top};
+    };
+
+    auto replicateBorder = [&](uint8_t* buffer, int m, const Rect& area) {
+        int left = tile.x - m, right = tile.x + tile.width + m;
+        int areaRight = area.x + area.width, areaBottom = area.y + area.height;
+        for (int y = area.y; y < areaBottom; ++y) {
+            std::fill(at(buffer, left, y), at(buffer, area.x, y), *at(buffer, area.x, y));
+            std::fill(at(buffer, areaRight, y), at(buffer, right, y), *at(buffer, areaRight - 1, y));
+        }
+        for (int y = tile.y - m; y < area.y; ++y) {
+            std::memcpy(at(buffer, left, y), at(buffer, left, area.y), right - left);
+        }
+        for (int y = areaBottom; y < tile.y + tile.height + m; ++y) {
+            std::memcpy(at(buffer, left, y), at(buffer, left, areaBottom - 1), right - left);
+        }
+    };
+
+    uint8_t* current = buffers[0];
+    uint8_t* next = buffers[1];
+    Rect area = inside(margin);
+    for (int y = area.y; y < area.y + area.height; ++y) {
+        Image::convertToGrayscale(image.row(y) + static_cast<size_t>(area.x) * image.channels, at(current, area.x, y),
+                                  area.width, image.channels, luma);
+    }
+    replicateBorder(current, margin, area);
+
+    for (const Stage& stage : stages) {
+        if (!stage.rowKernel) {
+            // Pointwise: replicated pixels map like the ones they copy, so the border stays valid
+            for (int y = tile.y - margin; y < tile.y + tile.height + margin; ++y) {
+                uint8_t* row = at(current, tile.x - margin, y);
+                for (int x = 0; x < tile.width + 2 * margin; ++x) {
+                    row[x] = stage.table[row[x]];
+                }
+            }
+            continue;
+        }
+
+        --margin;
+        area = inside(margin);
+        for (int y = area.y; y < area.y + area.height; ++y) {
+            stage.rowKernel(at(current, area.x - 1, y - 1), at(current, area.x - 1, y),
+                            at(current, area.x - 1, y + 1), at(next, area.x, y), area.width);
+        }
+        replicateBorder(next, margin, area);
+        std::swap(current, next);
+    }
+
+    for (int y = 0; y < tile.height; ++y) {
+        std::memcpy(output + y * outputStride, at(current, tile.x, tile.y + y), tile.width);
+    }
+}
@@ -0,0 +1,458 @@
+#include "EdgeServer.h"
+#include "EdgeDetector.h"
+#include "Image.h"
+#include "PngEncoder.h"
+#include "PnmIO.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Longest request line accepted; the line only carries options and paths
+constexpr size_t MAX_LINE_BYTES = 64 * 1024;
+
+// Pause before accepting again after a resource error such as EMFILE
+constexpr std::chrono::milliseconds ACCEPT_RETRY_DELAY{50};
+
+// Thrown when the peer closed the connection or the socket failed
+struct ConnectionClosed {};
+
+// Buffered reads from a connected socket
+class SocketReader {
+public:
+    explicit SocketReader(int socket) : socket(socket) {}
+
+    // Returns false on a clean end of stream before any byte of the line
+    bool readLine(std::string& line) {
+        line.clear();
+        while (true) {
+            auto newline = std::find(buffer.begin() + position, buffer.begin() + filled, '\n');
+            line.append(buffer.begin() + position, newline);
+            if (newline != buffer.begin() + filled) {
+                position = static_cast<size_t>(newline - buffer.begin()) + 1;
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                return true;
+            }
+            position = filled;
+            if (line.size() > MAX_LINE_BYTES) {
+                throw std::runtime_error("Request line too long");
+            }
+            if (!fill()) {
+                if (line.empty()) {
+                    return false;
+                }
+                throw ConnectionClosed{};
+            }
+        }
+    }
+
+    void readExact(uint8_t* destination, size_t size) {
+        size_t buffered = std::min(size, filled - position);
+        std::copy(buffer.begin() + position, buffer.begin() + position + buffered, destination);
+        position += buffered;
+
+        // Large payloads bypass the line buffer
+        for (size_t done = buffered; done < size;) {
+            ssize_t received = ::recv(socket, destination + done, size - done, 0);
+            if (received <= 0) {
+                if (received < 0 && errno == EINTR) {
+                    continue;
+                }
+                throw ConnectionClosed{};
+            }
+            done += static_cast<size_t>(received);
+        }
+    }
+
+private:
+    bool fill() {
+        while (true) {
+            ssize_t received = ::recv(socket, buffer.data(), buffer.size(), 0);
+            if (received > 0) {
+                position = 0;
+                filled = static_cast<size_t>(received);
+                return true;
+            }
+            if (received == 0) {
+                return false;
+            }
+            if (errno != EINTR) {
+                throw ConnectionClosed{};
+            }
+        }
+    }
+
+    int socket;
+    std::vector<uint8_t> buffer = std::vector<uint8_t>(16 * 1024);
+    size_t position = 0;
+    size_t filled = 0;
+};
+
+void sendAll(int socket, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        // MSG_NOSIGNAL: a client hanging up must not kill the daemon with SIGPIPE
+        ssize_t sent = ::send(socket, bytes, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw ConnectionClosed{};
+        }
+        bytes += sent;
+        size -= static_cast<size_t>(sent);
+    }
+}
+
+std::string percentDecode(const std::string& value) {
+    std::string decoded;
+    for (size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size() && std::isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+            decoded += static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            decoded += value[i];
+        }
+    }
+    return decoded;
+}
+
+// Request line split into its command and key=value arguments
+struct Request {
+    std::string command;
+    std::map<std::string, std::string> arguments;
+
+    bool has(const std::string& key) const { return arguments.count(key) != 0; }
+    std::string get(const std::string& key, const std::string& fallback) const {
+        auto it = arguments.find(key);
+        return it == arguments.end() ? fallback : it->second;
+    }
+    std::string require(const std::string& key) const {
+        auto it = arguments.find(key);
+        if (it == arguments.end()) {
+            throw std::invalid_argument("Missing request argument: " + key);
+        }
+        return it->second;
+    }
+    int integer(const std::string& key, int fallback) const {
+        std::string value = get(key, std::to_string(fallback));
+        try {
+            size_t parsed = 0;
+            int result = std::stoi(value, &parsed);
+            if (parsed == value.size()) {
+                return result;
+            }
+        } catch (const std::exception&) {
+        }
+        throw std::invalid_argument("Invalid " + key + ": " + value);
+    }
+};
+
+Request parseRequest(const std::string& line) {
+    Request request;
+    std::istringstream tokens(line);
+    tokens >> request.command;
+    std::string token;
+    while (tokens >> token) {
+        size_t equals = token.find('=');
+        if (equals == std::string::npos || equals == 0) {
+            throw std::invalid_argument("Malformed request argument: " + token);
+        }
+        request.arguments[token.substr(0, equals)] = percentDecode(token.substr(equals + 1));
+    }
+    return request;
+}
+
+struct RawGeometry {
+    int width = 0, height = 0, channels = 0;
+};
+
+RawGeometry parseGeometry(const std::string& geometry) {
+    RawGeometry size;
+    char separator1 = 0, separator2 = 0;
+    std::istringstream parser(geometry);
+    if (!(parser >> size.width >> separator1 >> size.height >> separator2 >> size.channels) ||
+        separator1 != 'x' || separator2 != 'x' || !parser.eof()) {
+        throw std::invalid_argument("Invalid raw size: " + geometry + " (expected WxHxC)");
+    }
+    return size;
+}
+
+bool isCanny(std::string name) {
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    return name == "canny";
+}
+
+int64_t elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+EdgeServer::EdgeServer(const ServerOptions& options) : options(options) {
+    sockaddr_un address{};
+    if (options.socketPath.empty() || options.socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: '" + options.socketPath + "'");
+    }
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    // A socket file left behind by a previous daemon would make bind fail
+    struct stat status;
+    if (::stat(options.socketPath.c_str(), &status) == 0 && S_ISSOCK(status.st_mode)) {
+        ::unlink(options.socketPath.c_str());
+    }
+
+    listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        throw std::runtime_error("Failed to create socket: " + std::string(std::strerror(errno)));
+    }
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0) {
+        std::string reason = std::strerror(errno);
+        ::close(listener);
+        throw std::runtime_error("Failed to listen on " + options.socketPath + ": " + reason);
+    }
+}
+
+EdgeServer::~EdgeServer() {
+    stop();
+    ::close(listener);
+    ::unlink(options.socketPath.c_str());
+}
+
+void EdgeServer::run() {
+    unsigned workerCount = options.workers ? options.workers : std::max(2u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    try {
+        for (unsigned i = 0; i < workerCount; ++i) {
+            workers.emplace_back(&EdgeServer::workerLoop, this);
+        }
+    } catch (...) {
+        // Joinable threads must not be destroyed, so stop the workers already serving
+        stop();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        throw;
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void EdgeServer::stop() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+    // shutdown() wakes workers blocked in accept() or recv() without closing the
+    // descriptors under them; each worker closes its own connection
+    ::shutdown(listener, SHUT_RDWR);
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (int connection : connections) {
+        ::shutdown(connection, SHUT_RDWR);
+    }
+}
+
+void EdgeServer::workerLoop() {
+    Profiler::WorkerSection section;  // Connections are served concurrently
+    while (!stopping.load()) {
+        int connection = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (connection < 0) {
+            if (errno != EINTR && errno != ECONNABORTED && !stopping.load()) {
+                // Out of descriptors or memory (EMFILE, ENFILE, ENOBUFS, ENOMEM): these pass
+                // once connections close, so back off instead of giving up the worker
+                std::this_thread::sleep_for(ACCEPT_RETRY_DELAY);
+            }
+            continue;  // The loop condition ends the worker once stop() shut the listener down
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            if (stopping.load()) {
+                ::close(connection);
+                break;
+            }
+            connections.insert(connection);
+        }
+        serveConnection(connection);
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            connections.erase(connection);
+        }
+        ::close(connection);
+    }
+}
+
+void EdgeServer::serveConnection(int connection) {
+    // Per-worker state survives across requests and connections of this thread
+    thread_local EdgeDetector::Workspace workspace;
+    SocketReader reader(connection);
+    std::string line;
+    std::vector<uint8_t> payload;
+    std::vector<uint8_t> result;      // Inline response payload, reused across requests
+
+    try {
+        while (reader.readLine(line)) {
+            if (line.empty()) {
+                continue;
+            }
+            auto start = std::chrono::steady_clock::now();
+            std::string response;
+            result.clear();
+
+            try {
+                Request request = parseRequest(line);
+                if (request.command == "ping") {
+                    sendAll(connection, "ok\n", 3);
+                    continue;
+                }
+
+                // The payload is consumed before validation so a bad request keeps the stream in sync
+                size_t payloadSize = 0;
+                if (request.get("input", "") == "-") {
+                    std::string size = request.get("size", "");
+                    char* end = nullptr;
+                    unsigned long long parsed = std::strtoull(size.c_str(), &end, 10);
+                    if (size.empty() || *end != '\0' || size[0] == '-' || parsed > options.maxPayloadBytes) {
+                        // The stream cannot be resynchronized past a payload of unknown size
+                        std::string error = "error Missing or out of range payload size: '" + size + "'\n";
+                        sendAll(connection, error.data(), error.size());
+                        return;
+                    }
+                    payloadSize = static_cast<size_t>(parsed);
+                    payload.resize(payloadSize);
+                    reader.readExact(payload.data(), payloadSize);
+                }
+                if (request.command != "detect") {
+                    throw std::invalid_argument("Unknown command: " + request.command);
+                }
+
+                // Load: paths go through Image, inline raw and PGM/PPM inputs are viewed in
+                // place, other inline formats are decoded from the payload buffer
+                std::string operatorName = request.require("operator");
+                std::string input = request.require("input");
+                std::optional<Image> image;
+                ImageView view{};
+                if (input == "-") {
+                    if (request.has("raw")) {
+                        RawGeometry size = parseGeometry(request.get("raw", ""));
+                        if (size.width <= 0 || size.height <= 0 ||
+                            static_cast<size_t>(size.width) * size.height * size.channels != payloadSize) {
+                            throw std::invalid_argument("Raw payload does not match " + request.get("raw", ""));
+                        }
+                        view = ImageView{payload.data(), size.width, size.height, size.channels,
+                                         static_cast<size_t>(size.width) * size.channels};
+                    } else if (payloadSize < 2 || payload[0] != 'P' || (payload[1] != '5' && payload[1] != '6')) {
+                        image = Image::loadFromMemory(ByteSpan(payload.data(), payloadSize));
+                        view = image->view();
+                    } else {
+                        PnmHeader header = PnmIO::parseHeader(payload.data(), payloadSize);
+                        if (payloadSize - header.dataOffset <
+                            static_cast<size_t>(header.width) * header.height * header.channels) {
+                            throw std::invalid_argument("Truncated PGM/PPM payload");
+                        }
+                        view = ImageView{payload.data() + header.dataOffset, header.width, header.height,
+                                         header.channels, static_cast<size_t>(header.width) * header.channels};
+                    }
+                } else {
+                    if (request.has("raw")) {
+                        RawGeometry size = parseGeometry(request.get("raw", ""));
+                        image = Image::loadRaw(input, size.width, size.height, size.channels);
+                    } else {
+                        image = Image::loadFromFile(input);
+                    }
+                    view = image->view();
+                }
+                int64_t decodeUs = elapsedUs(start);
+
+                // Detect into a pooled buffer
+                auto detectStart = std::chrono::steady_clock::now();
+                EdgeDetectionOptions detection;
+                detection.norm = EdgeDetector::parseNorm(request.get("norm", "L2"));
+                // Multi-threaded requests all share the one hardware_concurrency pool and take
+                // turns on it, so clients cannot multiply threads or pools
+                int threads = request.integer("threads", 1);
+                if (threads < 0) {
+                    throw std::invalid_argument("Invalid threads: " + request.get("threads", ""));
+                }
+                detection.threads = threads == 1 ? 1 : 0;
+                detection.tiles = options.tiles;
+                std::shared_ptr<uint8_t> edges = resultBuffers.acquire(static_cast<size_t>(view.width) * view.height);
+                if (isCanny(operatorName)) {
+                    CannyOptions canny;
+                    canny.threads = detection.threads;
+                    canny.lowThreshold = request.integer("canny-low", canny.lowThreshold);
+                    canny.highThreshold = request.integer("canny-high", canny.highThreshold);
+                    EdgeDetector::detectCannyInto(view, edges.get(), view.width, canny);
+                } else {
+                    EdgeDetector::detectEdgesInto(view, operatorName, edges.get(), view.width, workspace, detection);
+                }
+                Image edgeImage(std::shared_ptr<const uint8_t>(std::move(edges)), view.width, view.height, 1);
+                int64_t detectUs = elapsedUs(detectStart);
+
+                // Encode to the output path or into the response
+                auto encodeStart = std::chrono::steady_clock::now();
+                PngOptions png;
+                png.compressionLevel = request.integer("png-level", png.compressionLevel);
+                png.filter = PngEncoder::parseFilter(request.get("png-filter", "adaptive"));
+                std::string output = request.require("output");
+                if (output != "-") {
+                    edgeImage.saveToFile(output, png);
+                } else {
+                    std::string format = request.get("format", "png");
+                    if (format == "png") {
+                        edgeImage.encodePng(result, png);
+                    } else if (format == "pgm" || format == "raw") {
+                        std::string header = format == "pgm" ? PnmIO::formatHeader(view.width, view.height, 1) : "";
+                        result.assign(header.begin(), header.end());
+                        result.insert(result.end(), edgeImage.getData().begin(), edgeImage.getData().end());
+                    } else {
+                        throw std::invalid_argument("Unknown output format: " + format +
+                                                    ". Supported formats: png, pgm, raw");
+                    }
+                }
+                int64_t encodeUs = elapsedUs(encodeStart);
+
+                response = "ok width=" + std::to_string(view.width) + " height=" + std::to_string(view.height) +
+                           " decode_us=" + std::to_string(decodeUs) + " detect_us=" + std::to_string(detectUs) +
+                           " encode_us=" + std::to_string(encodeUs) + " total_us=" + std::to_string(elapsedUs(start)) +
+                           " size=" + std::to_string(result.size()) + "\n";
+            } catch (const ConnectionClosed&) {
+                throw;
+            } catch (const std::exception& e) {
+                std::string message = e.what();
+                std::replace(message.begin(), message.end(), '\n', ' ');
+                response = "error " + message + "\n";
+                result.clear();
+            }
+
+            sendAll(connection, response.data(), response.size());
+            sendAll(connection, result.data(), result.size());
+        }
+    } catch (const ConnectionClosed&) {
+        // Peer went away or stop() shut the socket down
+    } catch (const std::exception& e) {
+        std::string response = "error " + std::string(e.what()) + "\n";
+        try {
+            sendAll(connection, response.data(), response.size());
+        } catch (const ConnectionClosed&) {
+        }
+    }
+}
@@ -0,0 +1,210 @@
+#include "FrameSequence.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+FrameSequence::FrameSequence(const std::string& operatorName, const SequenceOptions& options)
+    : op(EdgeDetector::parseOperator(operatorName)), options(options) {
+    if (options.tileSize < 2) {
+        throw std::invalid_argument("Tile size must be at least 2, got " + std::to_string(options.tileSize));
+    }
+    unsigned threads = options.detection.threads;
+    workspaces.resize(threads == 1 ? 1 : ThreadPool::shared(threads).size());
+}
+
+FrameUpdate FrameSequence::process(const ImageView& frame) {
+    if (startFrame(frame)) {
+        return result(dirty.size(), true);
+    }
+
+    {
+        Profiler::Scope scope("diff", 2 * static_cast<size_t>(width) * height * channels);
+        std::fill(dirty.begin(), dirty.end(), 0);
+        auto diffRow = [&](size_t tileRow, size_t) {
+            diffTileRow(frame, static_cast<int>(tileRow));
+            copyDirtyTiles(frame, static_cast<int>(tileRow));
+        };
+        forEachIndex(tileRows, diffRow);
+    }
+    return update(frame);
+}
+
+FrameUpdate FrameSequence::process(const ImageView& frame, const std::vector<Rect>& dirtyRects) {
+    for (const Rect& rect : dirtyRects) {
+        if (rect.width < 1 || rect.height < 1 || rect.x < 0 || rect.y < 0 ||
+            rect.width > frame.width - rect.x || rect.height > frame.height - rect.y) {
+            throw std::invalid_argument("Dirty rectangle " + std::to_string(rect.width) + "x" +
+                                        std::to_string(rect.height) + "+" + std::to_string(rect.x) + "+" +
+                                        std::to_string(rect.y) + " is empty or outside the " +
+                                        std::to_string(frame.width) + "x" + std::to_string(frame.height) + " frame");
+        }
+    }
+    if (startFrame(frame)) {
+        return result(dirty.size(), true);
+    }
+
+    std::fill(dirty.begin(), dirty.end(), 0);
+    int tileSize = options.tileSize;
+    for (const Rect& rect : dirtyRects) {
+        for (int tileRow = rect.y / tileSize; tileRow <= (rect.y + rect.height - 1) / tileSize; ++tileRow) {
+            for (int column = rect.x / tileSize; column <= (rect.x + rect.width - 1) / tileSize; ++column) {
+                dirty[static_cast<size_t>(tileRow) * tileColumns + column] = 1;
+            }
+        }
+    }
+    auto copyRow = [&](size_t tileRow, size_t) { copyDirtyTiles(frame, static_cast<int>(tileRow)); };
+    forEachIndex(tileRows, copyRow);
+    return update(frame);
+}
+
+void FrameSequence::reset() {
+    width = height = channels = 0;
+}
+
+bool FrameSequence::startFrame(const ImageView& frame) {
+    size_t rowBytes = static_cast<size_t>(frame.width) * frame.channels;
+    if (!frame.data || frame.width < 1 || frame.height < 1 || frame.stride < rowBytes) {
+        throw std::runtime_error("Invalid frame data. Expected row size: " + std::to_string(rowBytes) +
+                                 ", Actual stride: " + std::to_string(frame.stride));
+    }
+    if (frame.width == width && frame.height == height && frame.channels == channels) {
+        return false;
+    }
+
+    // Stays reset if detection throws, so the next frame is computed in full again
+    reset();
+    edges.resize(static_cast<size_t>(frame.width) * frame.height);
+    EdgeDetector::detectEdgesInto(frame, op, edges.data(), frame.width, workspaces[0], options.detection);
+
+    previous.resize(rowBytes * frame.height);
+    for (int y = 0; y < frame.height; ++y) {
+        std::memcpy(previous.data() + y * rowBytes, frame.row(y), rowBytes);
+    }
+    tileColumns = (frame.width + options.tileSize - 1) / options.tileSize;
+    tileRows = (frame.height + options.tileSize - 1) / options.tileSize;
+    dirty.assign(static_cast<size_t>(tileColumns) * tileRows, 1);
+    width = frame.width;
+    height = frame.height;
+    channels = frame.channels;
+    return true;
+}
+
+// Compares the tile row line by line; memcmp is vectorized by the C library and
+// tiles already found dirty are skipped for the remaining lines
+void FrameSequence::diffTileRow(const ImageView& frame, int tileRow) {
+    size_t rowBytes = static_cast<size_t>(width) * channels;
+    size_t tileBytes = static_cast<size_t>(options.tileSize) * channels;
+    uint8_t* flags = dirty.data() + static_cast<size_t>(tileRow) * tileColumns;
+    int clean = tileColumns;
+
+    int firstRow = tileRow * options.tileSize;
+    int lastRow = std::min(height, firstRow + options.tileSize);
+    for (int y = firstRow; y < lastRow && clean > 0; ++y) {
+        const uint8_t* current = frame.row(y);
+        const uint8_t* before = previous.data() + y * rowBytes;
+        for (int column = 0; column < tileColumns; ++column) {
+            size_t offset = column * tileBytes;
+            if (!flags[column] && std::memcmp(current + offset, before + offset,
+                                              std::min(tileBytes, rowBytes - offset)) != 0) {
+                flags[column] = 1;
+                --clean;
+            }
+        }
+    }
+}
+
+void FrameSequence::copyDirtyTiles(const ImageView& frame, int tileRow) {
+    size_t rowBytes = static_cast<size_t>(width) * channels;
+    size_t tileBytes = static_cast<size_t>(options.tileSize) * channels;
+    const uint8_t* flags = dirty.data() + static_cast<size_t>(tileRow) * tileColumns;
+
+    int firstRow = tileRow * options.tileSize;
+    int lastRow = std::min(height, firstRow + options.tileSize);
+    for (int first = 0; first < tileColumns;) {
+        if (!flags[first]) {
+            ++first;
+            continue;
+        }
+        int last = first;
+        while (last < tileColumns && flags[last]) {
+            ++last;
+        }
+        size_t offset = first * tileBytes;
+        size_t bytes = std::min(last * tileBytes, rowBytes) - offset;
+        for (int y = firstRow; y < lastRow; ++y) {
+            std::memcpy(previous.data() + y * rowBytes + offset, frame.row(y) + offset, bytes);
+        }
+        first = last;
+    }
+}
+
+// Recomputes each horizontal run of dirty tiles grown by the 1-pixel halo, since
+// output pixels next to a changed input pixel change too. Detection reads the halo
+// of the grown run from the frame, so the result equals a full recompute
+void FrameSequence::recomputeTileRow(const ImageView& frame, int tileRow, EdgeDetector::Workspace& workspace) {
+    EdgeDetectionOptions detection = options.detection;
+    detection.threads = 1;
+    const uint8_t* flags = dirty.data() + static_cast<size_t>(tileRow) * tileColumns;
+    int tileSize = options.tileSize;
+
+    for (int first = 0; first < tileColumns;) {
+        if (!flags[first]) {
+            ++first;
+            continue;
+        }
+        int last = first;
+        while (last < tileColumns && flags[last]) {
+            ++last;
+        }
+        int left = std::max(0, first * tileSize - 1);
+        int top = std::max(0, tileRow * tileSize - 1);
+        int right = std::min(width, last * tileSize + 1);
+        int bottom = std::min(height, (tileRow + 1) * tileSize + 1);
+        Rect run{left, top, right - left, bottom - top};
+        EdgeDetector::detectRegionInto(frame, op, run, edges.data() + static_cast<size_t>(top) * width + left,
+                                       width, workspace, detection);
+        first = last;
+    }
+}
+
+FrameUpdate FrameSequence::update(const ImageView& frame) {
+    // Grown runs reach one pixel into the neighbouring tile rows, so rows of equal
+    // parity are recomputed together and no two workers write the same pixel
+    for (int parity = 0; parity < 2; ++parity) {
+        auto recompute = [&](size_t index, size_t worker) {
+            recomputeTileRow(frame, static_cast<int>(2 * index) + parity, workspaces[worker]);
+        };
+        forEachIndex(static_cast<size_t>(tileRows - parity + 1) / 2, recompute);
+    }
+
+    return result(static_cast<size_t>(std::count(dirty.begin(), dirty.end(), 1)), false);
+}
+
+FrameUpdate FrameSequence::result(size_t dirtyTiles, bool fullFrame) const {
+    return FrameUpdate{ImageView{edges.data(), width, height, 1, static_cast<size_t>(width)},
+                       dirtyTiles, dirty.size(), fullFrame};
+}
+
+template <typename Task>
+void FrameSequence::forEachIndex(size_t count, Task& task) {
+    size_t workers = std::min(workspaces.size(), count);
+    if (workers <= 1) {
+        for (size_t index = 0; index < count; ++index) {
+            task(index, 0);
+        }
+        return;
+    }
+
+    // Workers claim indices in order, so uneven rows (little or much motion) balance out
+    std::atomic<size_t> next{0};
+    auto runWorker = [&](size_t worker) {
+        for (size_t index; (index = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+            task(index, worker);
+        }
+    };
+    ThreadPool::shared(options.detection.threads).parallelFor(workers, std::ref(runWorker));
+}
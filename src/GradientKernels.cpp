@@ -0,0 +1,729 @@
+#include "GradientKernels.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+// SIMD variants rely on GCC/Clang target attributes so that one portable binary
+// can carry AVX2/AVX-512 code paths without compiling the whole project for them
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GRADIENT_KERNELS_X86 1
+#include <immintrin.h>
+#else
+#define GRADIENT_KERNELS_X86 0
+#endif
+
+namespace {
+
+using RowKernel = GradientKernels::RowKernel;
+
+// Smoothing vector of a separable operator: the right column of its X kernel
+template <typename Operator, int Index>
+constexpr int smoothingWeight() {
+    static_assert(EdgeOperatorTraits::isSeparable<Operator>(), "SIMD row kernels need a separable operator");
+    return Operator::kernelX[Index][2];
+}
+
+// Scalar reference: keeps a sliding window of three column sums so each padded
+// column is smoothed and differenced exactly once
+template <typename Operator, GradientNorm Norm, bool StorePlanes>
+void scalarGradients(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                     uint8_t* output, int16_t* gxRow, int16_t* gyRow, int width) {
+    constexpr int w0 = smoothingWeight<Operator, 0>();
+    constexpr int w1 = smoothingWeight<Operator, 1>();
+    constexpr int w2 = smoothingWeight<Operator, 2>();
+    const uint8_t* sqrtTable = GradientKernels::squareRootTable();
+    auto smooth = [&](int x) {
+        return w0 * above[x] + w1 * center[x] + w2 * below[x];
+    };
+
+    int s0 = smooth(0), s1 = smooth(1);
+    int d0 = below[0] - above[0], d1 = below[1] - above[1];
+
+    for (int x = 0; x < width; ++x) {
+        int s2 = smooth(x + 2);
+        int d2 = below[x + 2] - above[x + 2];
+
+        int gx = s2 - s0;
+        int gy = w0 * d0 + w1 * d1 + w2 * d2;
+        output[x] = GradientKernels::magnitude<Norm>(gx, gy, sqrtTable);
+        if constexpr (StorePlanes) {
+            gxRow[x] = static_cast<int16_t>(gx);
+            gyRow[x] = static_cast<int16_t>(gy);
+        }
+
+        s0 = s1; s1 = s2;
+        d0 = d1; d1 = d2;
+    }
+}
+
+// Every implementation computes gx/gy anyway: the magnitude-only and the plane-storing
+// kernels are two instantiations of one function, so both stay bit-identical
+template <typename Operator, GradientNorm Norm>
+void scalarRow(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+               uint8_t* output, int width) {
+    scalarGradients<Operator, Norm, false>(above, center, below, output, nullptr, nullptr, width);
+}
+
+template <typename Operator, GradientNorm Norm>
+constexpr GradientKernels::PlaneRowKernel scalarPlaneRow = scalarGradients<Operator, Norm, true>;
+
+// Multi-operator kernels add the outer rows (or columns) of a difference before
+// weighting them, so one sum serves every operator; that needs w0 == w2
+template <typename Operator>
+constexpr int outerWeight() {
+    static_assert(smoothingWeight<Operator, 0>() == smoothingWeight<Operator, 2>(),
+                  "Multi-operator kernels need symmetric smoothing weights");
+    return smoothingWeight<Operator, 0>();
+}
+
+template <typename Operator>
+constexpr int middleWeight() {
+    return smoothingWeight<Operator, 1>();
+}
+
+template <typename Operator, unsigned Operators>
+constexpr bool inSet() {
+    return (Operators & GradientKernels::operatorBit(Operator::id)) != 0;
+}
+
+template <typename Operator, unsigned Operators, GradientNorm Norm>
+inline void scalarMultiStore(int dxOuter, int dxMiddle, int dyOuter, int dyMiddle, uint8_t* const* outputs,
+                             int x, const uint8_t* sqrtTable) {
+    if constexpr (inSet<Operator, Operators>()) {
+        int gx = outerWeight<Operator>() * dxOuter + middleWeight<Operator>() * dxMiddle;
+        int gy = outerWeight<Operator>() * dyOuter + middleWeight<Operator>() * dyMiddle;
+        outputs[static_cast<int>(Operator::id)][x] = GradientKernels::magnitude<Norm>(gx, gy, sqrtTable);
+    }
+}
+
+// gx of every built-in operator weighs the same three row differences (right minus
+// left) and gy the same three column differences (below minus above); with equal
+// outer weights only two partial sums per direction remain: outer and middle
+template <unsigned Operators, GradientNorm Norm>
+void scalarMultiRow(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                    uint8_t* const* outputs, int width) {
+    const uint8_t* sqrtTable = GradientKernels::squareRootTable();
+    for (int x = 0; x < width; ++x) {
+        int dxOuter = (above[x + 2] - above[x]) + (below[x + 2] - below[x]);
+        int dxMiddle = center[x + 2] - center[x];
+        int dyOuter = (below[x] - above[x]) + (below[x + 2] - above[x + 2]);
+        int dyMiddle = below[x + 1] - above[x + 1];
+        scalarMultiStore<SobelOperator, Operators, Norm>(dxOuter, dxMiddle, dyOuter, dyMiddle, outputs, x, sqrtTable);
+        scalarMultiStore<PrewittOperator, Operators, Norm>(dxOuter, dxMiddle, dyOuter, dyMiddle, outputs, x,
+                                                           sqrtTable);
+        scalarMultiStore<ScharrOperator, Operators, Norm>(dxOuter, dxMiddle, dyOuter, dyMiddle, outputs, x,
+                                                          sqrtTable);
+    }
+}
+
+// Output pointers of a multi-operator kernel moved x pixels right; unused entries stay null
+struct MultiOutputs {
+    uint8_t* planes[3];
+
+    MultiOutputs(uint8_t* const* outputs, int x) {
+        for (int op = 0; op < 3; ++op) {
+            planes[op] = outputs[op] ? outputs[op] + x : nullptr;
+        }
+    }
+};
+
+// Offsets an optional plane pointer; magnitude-only kernels pass null planes
+template <bool StorePlanes>
+inline int16_t* advance(int16_t* plane, int x) {
+    return StorePlanes ? plane + x : nullptr;
+}
+
+// Row kernel table of one implementation for every built-in operator and norm
+#define ROW_KERNELS(kernel)                                                                   \
+    {{kernel<SobelOperator, GradientNorm::L2>, kernel<SobelOperator, GradientNorm::L1>,       \
+      kernel<SobelOperator, GradientNorm::LInf>},                                             \
+     {kernel<PrewittOperator, GradientNorm::L2>, kernel<PrewittOperator, GradientNorm::L1>,   \
+      kernel<PrewittOperator, GradientNorm::LInf>},                                           \
+     {kernel<ScharrOperator, GradientNorm::L2>, kernel<ScharrOperator, GradientNorm::L1>,     \
+      kernel<ScharrOperator, GradientNorm::LInf>}}
+
+// Multi-operator kernel table of one implementation for every operator set and norm
+#define MULTI_ROW_NORMS(kernel, operators)                                                    \
+    {kernel<operators, GradientNorm::L2>, kernel<operators, GradientNorm::L1>,                \
+     kernel<operators, GradientNorm::LInf>}
+#define MULTI_ROW_KERNELS(kernel)                                                             \
+    {MULTI_ROW_NORMS(kernel, 0), MULTI_ROW_NORMS(kernel, 1), MULTI_ROW_NORMS(kernel, 2),      \
+     MULTI_ROW_NORMS(kernel, 3), MULTI_ROW_NORMS(kernel, 4), MULTI_ROW_NORMS(kernel, 5),      \
+     MULTI_ROW_NORMS(kernel, 6), MULTI_ROW_NORMS(kernel, 7)}
+
+#if GRADIENT_KERNELS_X86
+
+// L2 note: gx² + gy² < 2^24 for Sobel and Prewitt, so it converts to float exactly,
+// and a correctly rounded float sqrt truncates to the same integer as the
+// double-precision reference for every result that survives the clamp to 255.
+// Larger Scharr sums may round, but they are far above 255² and clamp either way.
+// Magnitudes leave each kernel as non-negative int16 lanes; unsigned saturation
+// when narrowing to bytes performs the clamp to 255.
+// Weights are template constants: unit weights skip the multiply and weight 2 becomes an add.
+
+// ---- SSE2: 8 int16 lanes, 16 pixels per iteration ----
+
+__attribute__((target("sse2")))
+inline __m128i sse2Load16(const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+template <int Weight>
+__attribute__((target("sse2")))
+inline __m128i sse2Scale(__m128i v) {
+    if constexpr (Weight == 1) {
+        return v;
+    } else if constexpr (Weight == 2) {
+        return _mm_add_epi16(v, v);
+    } else {
+        return _mm_mullo_epi16(v, _mm_set1_epi16(static_cast<int16_t>(Weight)));
+    }
+}
+
+// Weighted sum w0 * top + w1 * middle + w2 * bottom; symmetric weights share one scaling
+template <typename Operator>
+__attribute__((target("sse2")))
+inline __m128i sse2Smooth(__m128i top, __m128i middle, __m128i bottom) {
+    constexpr int w0 = smoothingWeight<Operator, 0>();
+    constexpr int w1 = smoothingWeight<Operator, 1>();
+    constexpr int w2 = smoothingWeight<Operator, 2>();
+    if constexpr (w0 == w2) {
+        return _mm_add_epi16(sse2Scale<w0>(_mm_add_epi16(top, bottom)), sse2Scale<w1>(middle));
+    } else {
+        return _mm_add_epi16(_mm_add_epi16(sse2Scale<w0>(top), sse2Scale<w1>(middle)), sse2Scale<w2>(bottom));
+    }
+}
+
+template <typename Operator>
+__attribute__((target("sse2")))
+inline void sse2Gradient(__m128i a0, __m128i a1, __m128i a2, __m128i c0, __m128i c2,
+                         __m128i b0, __m128i b1, __m128i b2, __m128i& gx, __m128i& gy) {
+    gx = _mm_sub_epi16(sse2Smooth<Operator>(a2, c2, b2), sse2Smooth<Operator>(a0, c0, b0));
+    gy = sse2Smooth<Operator>(_mm_sub_epi16(b0, a0), _mm_sub_epi16(b1, a1), _mm_sub_epi16(b2, a2));
+}
+
+// SSE2 has no pabsw: |v| = max(v, -v)
+__attribute__((target("sse2")))
+inline __m128i sse2Abs(__m128i v) {
+    return _mm_max_epi16(v, _mm_sub_epi16(_mm_setzero_si128(), v));
+}
+
+template <GradientNorm Norm>
+__attribute__((target("sse2")))
+inline __m128i sse2Magnitude(__m128i gx, __m128i gy) {
+    if constexpr (Norm == GradientNorm::L2) {
+        __m128i lo = _mm_unpacklo_epi16(gx, gy);
+        __m128i hi = _mm_unpackhi_epi16(gx, gy);
+        __m128i magLo = _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(lo, lo))));
+        __m128i magHi = _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(_mm_madd_epi16(hi, hi))));
+        return _mm_packs_epi32(magLo, magHi);
+    } else if constexpr (Norm == GradientNorm::L1) {
+        return _mm_adds_epi16(sse2Abs(gx), sse2Abs(gy));
+    } else {
+        return _mm_max_epi16(sse2Abs(gx), sse2Abs(gy));
+    }
+}
+
+template <typename Operator, GradientNorm Norm, bool StorePlanes>
+__attribute__((target("sse2")))
+void sse2Gradients(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                   uint8_t* output, int16_t* gxRow, int16_t* gyRow, int width) {
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i a0 = sse2Load16(above + x), a1 = sse2Load16(above + x + 1), a2 = sse2Load16(above + x + 2);
+        __m128i c0 = sse2Load16(center + x), c2 = sse2Load16(center + x + 2);
+        __m128i b0 = sse2Load16(below + x), b1 = sse2Load16(below + x + 1), b2 = sse2Load16(below + x + 2);
+
+        __m128i gx, gy;
+        sse2Gradient<Operator>(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(a2, zero),
+                               _mm_unpacklo_epi8(c0, zero), _mm_unpacklo_epi8(c2, zero),
+                               _mm_unpacklo_epi8(b0, zero), _mm_unpacklo_epi8(b1, zero), _mm_unpacklo_epi8(b2, zero),
+                               gx, gy);
+        __m128i magLo = sse2Magnitude<Norm>(gx, gy);
+        if constexpr (StorePlanes) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(gxRow + x), gx);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(gyRow + x), gy);
+        }
+
+        sse2Gradient<Operator>(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(a2, zero),
+                               _mm_unpackhi_epi8(c0, zero), _mm_unpackhi_epi8(c2, zero),
+                               _mm_unpackhi_epi8(b0, zero), _mm_unpackhi_epi8(b1, zero), _mm_unpackhi_epi8(b2, zero),
+                               gx, gy);
+        __m128i magHi = sse2Magnitude<Norm>(gx, gy);
+        if constexpr (StorePlanes) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(gxRow + x + 8), gx);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(gyRow + x + 8), gy);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + x), _mm_packus_epi16(magLo, magHi));
+    }
+
+    scalarGradients<Operator, Norm, StorePlanes>(above + x, center + x, below + x, output + x,
+                                                 advance<StorePlanes>(gxRow, x), advance<StorePlanes>(gyRow, x),
+                                                 width - x);
+}
+
+template <typename Operator, GradientNorm Norm>
+__attribute__((target("sse2")))
+void sse2Row(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+             uint8_t* output, int width) {
+    sse2Gradients<Operator, Norm, false>(above, center, below, output, nullptr, nullptr, width);
+}
+
+template <typename Operator, GradientNorm Norm>
+constexpr GradientKernels::PlaneRowKernel sse2PlaneRow = sse2Gradients<Operator, Norm, true>;
+
+// Partial sums shared by all operators of a multi-operator kernel (see scalarMultiRow)
+struct Sse2Differences {
+    __m128i dxOuter, dxMiddle, dyOuter, dyMiddle;
+};
+
+__attribute__((target("sse2")))
+inline Sse2Differences sse2Differences(__m128i a0, __m128i a1, __m128i a2, __m128i c0, __m128i c2,
+                                       __m128i b0, __m128i b1, __m128i b2) {
+    return {_mm_add_epi16(_mm_sub_epi16(a2, a0), _mm_sub_epi16(b2, b0)), _mm_sub_epi16(c2, c0),
+            _mm_add_epi16(_mm_sub_epi16(b0, a0), _mm_sub_epi16(b2, a2)), _mm_sub_epi16(b1, a1)};
+}
+
+template <typename Operator, GradientNorm Norm>
+__attribute__((target("sse2")))
+inline __m128i sse2MultiMagnitude(const Sse2Differences& d) {
+    __m128i gx = _mm_add_epi16(sse2Scale<outerWeight<Operator>()>(d.dxOuter),
+                               sse2Scale<middleWeight<Operator>()>(d.dxMiddle));
+    __m128i gy = _mm_add_epi16(sse2Scale<outerWeight<Operator>()>(d.dyOuter),
+                               sse2Scale<middleWeight<Operator>()>(d.dyMiddle));
+    return sse2Magnitude<Norm>(gx, gy);
+}
+
+template <typename Operator, unsigned Operators, GradientNorm Norm>
+__attribute__((target("sse2")))
+inline void sse2MultiStore(const Sse2Differences& lo, const Sse2Differences& hi, uint8_t* const* outputs, int x) {
+    if constexpr (inSet<Operator, Operators>()) {
+        __m128i packed = _mm_packus_epi16(sse2MultiMagnitude<Operator, Norm>(lo),
+                                          sse2MultiMagnitude<Operator, Norm>(hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(outputs[static_cast<int>(Operator::id)] + x), packed);
+    }
+}
+
+template <unsigned Operators, GradientNorm Norm>
+__attribute__((target("sse2")))
+void sse2MultiRow(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                  uint8_t* const* outputs, int width) {
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i a0 = sse2Load16(above + x), a1 = sse2Load16(above + x + 1), a2 = sse2Load16(above + x + 2);
+        __m128i c0 = sse2Load16(center + x), c2 = sse2Load16(center + x + 2);
+        __m128i b0 = sse2Load16(below + x), b1 = sse2Load16(below + x + 1), b2 = sse2Load16(below + x + 2);
+
+        Sse2Differences lo = sse2Differences(
+            _mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(a2, zero),
+            _mm_unpacklo_epi8(c0, zero), _mm_unpacklo_epi8(c2, zero),
+            _mm_unpacklo_epi8(b0, zero), _mm_unpacklo_epi8(b1, zero), _mm_unpacklo_epi8(b2, zero));
+        Sse2Differences hi = sse2Differences(
+            _mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(a2, zero),
+            _mm_unpackhi_epi8(c0, zero), _mm_unpackhi_epi8(c2, zero),
+            _mm_unpackhi_epi8(b0, zero), _mm_unpackhi_epi8(b1, zero), _mm_unpackhi_epi8(b2, zero));
+        sse2MultiStore<SobelOperator, Operators, Norm>(lo, hi, outputs, x);
+        sse2MultiStore<PrewittOperator, Operators, Norm>(lo, hi, outputs, x);
+        sse2MultiStore<ScharrOperator, Operators, Norm>(lo, hi, outputs, x);
+    }
+
+    scalarMultiRow<Operators, Norm>(above + x, center + x, below + x, MultiOutputs(outputs, x).planes, width - x);
+}
+
+// ---- AVX2: 16 int16 lanes, 32 pixels per iteration ----
+
+__attribute__((target("avx2")))
+inline __m256i avx2Load16(const uint8_t* p) {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+template <int Weight>
+__attribute__((target("avx2")))
+inline __m256i avx2Scale(__m256i v) {
+    if constexpr (Weight == 1) {
+        return v;
+    } else if constexpr (Weight == 2) {
+        return _mm256_add_epi16(v, v);
+    } else {
+        return _mm256_mullo_epi16(v, _mm256_set1_epi16(static_cast<int16_t>(Weight)));
+    }
+}
+
+template <typename Operator>
+__attribute__((target("avx2")))
+inline __m256i avx2Smooth(__m256i top, __m256i middle, __m256i bottom) {
+    constexpr int w0 = smoothingWeight<Operator, 0>();
+    constexpr int w1 = smoothingWeight<Operator, 1>();
+    constexpr int w2 = smoothingWeight<Operator, 2>();
+    if constexpr (w0 == w2) {
+        return _mm256_add_epi16(avx2Scale<w0>(_mm256_add_epi16(top, bottom)), avx2Scale<w1>(middle));
+    } else {
+        return _mm256_add_epi16(_mm256_add_epi16(avx2Scale<w0>(top), avx2Scale<w1>(middle)), avx2Scale<w2>(bottom));
+    }
+}
+
+template <GradientNorm Norm>
+__attribute__((target("avx2")))
+inline __m256i avx2Magnitude(__m256i gx, __m256i gy) {
+    if constexpr (Norm == GradientNorm::L2) {
+        // Unpack/pack operate within 128-bit lanes, so the round trip preserves pixel order
+        __m256i lo = _mm256_unpacklo_epi16(gx, gy);
+        __m256i hi = _mm256_unpackhi_epi16(gx, gy);
+        __m256i magLo = _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_madd_epi16(lo, lo))));
+        __m256i magHi = _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(_mm256_madd_epi16(hi, hi))));
+        return _mm256_packs_epi32(magLo, magHi);
+    } else if constexpr (Norm == GradientNorm::L1) {
+        return _mm256_adds_epi16(_mm256_abs_epi16(gx), _mm256_abs_epi16(gy));
+    } else {
+        return _mm256_max_epi16(_mm256_abs_epi16(gx), _mm256_abs_epi16(gy));
+    }
+}
+
+// packus interleaves 64-bit halves across lanes; permute restores pixel order
+__attribute__((target("avx2")))
+inline void avx2StoreMagnitudes(uint8_t* output, __m256i first, __m256i second) {
+    __m256i packed = _mm256_packus_epi16(first, second);
+    packed = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output), packed);
+}
+
+// Magnitudes of 16 pixels; with StorePlanes the int16 gx/gy lanes go to the planes as well
+template <typename Operator, GradientNorm Norm, bool StorePlanes>
+__attribute__((target("avx2")))
+inline __m256i avx2Magnitude16(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                               int16_t* gxRow, int16_t* gyRow) {
+    __m256i a0 = avx2Load16(above), a1 = avx2Load16(above + 1), a2 = avx2Load16(above + 2);
+    __m256i b0 = avx2Load16(below), b1 = avx2Load16(below + 1), b2 = avx2Load16(below + 2);
+
+    __m256i gx = _mm256_sub_epi16(avx2Smooth<Operator>(a2, avx2Load16(center + 2), b2),
+                                  avx2Smooth<Operator>(a0, avx2Load16(center), b0));
+    __m256i gy = avx2Smooth<Operator>(_mm256_sub_epi16(b0, a0), _mm256_sub_epi16(b1, a1), _mm256_sub_epi16(b2, a2));
+    if constexpr (StorePlanes) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(gxRow), gx);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(gyRow), gy);
+    }
+    return avx2Magnitude<Norm>(gx, gy);
+}
+
+template <typename Operator, GradientNorm Norm, bool StorePlanes>
+__attribute__((target("avx2")))
+void avx2Gradients(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                   uint8_t* output, int16_t* gxRow, int16_t* gyRow, int width) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i first = avx2Magnitude16<Operator, Norm, StorePlanes>(
+            above + x, center + x, below + x, advance<StorePlanes>(gxRow, x), advance<StorePlanes>(gyRow, x));
+        __m256i second = avx2Magnitude16<Operator, Norm, StorePlanes>(
+            above + x + 16, center + x + 16, below + x + 16,
+            advance<StorePlanes>(gxRow, x + 16), advance<StorePlanes>(gyRow, x + 16));
+        avx2StoreMagnitudes(output + x, first, second);
+    }
+
+    sse2Gradients<Operator, Norm, StorePlanes>(above + x, center + x, below + x, output + x,
+                                               advance<StorePlanes>(gxRow, x), advance<StorePlanes>(gyRow, x),
+                                               width - x);
+}
+
+template <typename Operator, GradientNorm Norm>
+__attribute__((target("avx2")))
+void avx2Row(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+             uint8_t* output, int width) {
+    avx2Gradients<Operator, Norm, false>(above, center, below, output, nullptr, nullptr, width);
+}
+
+template <typename Operator, GradientNorm Norm>
+constexpr GradientKernels::PlaneRowKernel avx2PlaneRow = avx2Gradients<Operator, Norm, true>;
+
+struct Avx2Differences {
+    __m256i dxOuter, dxMiddle, dyOuter, dyMiddle;
+};
+
+// Shared partial sums of 16 pixels
+__attribute__((target("avx2")))
+inline Avx2Differences avx2Differences(const uint8_t* above, const uint8_t* center, const uint8_t* below) {
+    __m256i a0 = avx2Load16(above), a1 = avx2Load16(above + 1), a2 = avx2Load16(above + 2);
+    __m256i b0 = avx2Load16(below), b1 = avx2Load16(below + 1), b2 = avx2Load16(below + 2);
+    return {_mm256_add_epi16(_mm256_sub_epi16(a2, a0), _mm256_sub_epi16(b2, b0)),
+            _mm256_sub_epi16(avx2Load16(center + 2), avx2Load16(center)),
+            _mm256_add_epi16(_mm256_sub_epi16(b0, a0), _mm256_sub_epi16(b2, a2)), _mm256_sub_epi16(b1, a1)};
+}
+
+template <typename Operator, GradientNorm Norm>
+__attribute__((target("avx2")))
+inline __m256i avx2MultiMagnitude(const Avx2Differences& d) {
+    __m256i gx = _mm256_add_epi16(avx2Scale<outerWeight<Operator>()>(d.dxOuter),
+                                  avx2Scale<middleWeight<Operator>()>(d.dxMiddle));
+    __m256i gy = _mm256_add_epi16(avx2Scale<outerWeight<Operator>()>(d.dyOuter),
+                                  avx2Scale<middleWeight<Operator>()>(d.dyMiddle));
+    return avx2Magnitude<Norm>(gx, gy);
+}
+
+template <typename Operator, unsigned Operators, GradientNorm Norm>
+__attribute__((target("avx2")))
+inline void avx2MultiStore(const Avx2Differences& first, const Avx2Differences& second, uint8_t* const* outputs,
+                           int x) {
+    if constexpr (inSet<Operator, Operators>()) {
+        avx2StoreMagnitudes(outputs[static_cast<int>(Operator::id)] + x, avx2MultiMagnitude<Operator, Norm>(first),
+                            avx2MultiMagnitude<Operator, Norm>(second));
+    }
+}
+
+template <unsigned Operators, GradientNorm Norm>
+__attribute__((target("avx2")))
+void avx2MultiRow(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                  uint8_t* const* outputs, int width) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        Avx2Differences first = avx2Differences(above + x, center + x, below + x);
+        Avx2Differences second = avx2Differences(above + x + 16, center + x + 16, below + x + 16);
+        avx2MultiStore<SobelOperator, Operators, Norm>(first, second, outputs, x);
+        avx2MultiStore<PrewittOperator, Operators, Norm>(first, second, outputs, x);
+        avx2MultiStore<ScharrOperator, Operators, Norm>(first, second, outputs, x);
+    }
+
+    sse2MultiRow<Operators, Norm>(above + x, center + x, below + x, MultiOutputs(outputs, x).planes, width - x);
+}
+
+// ---- AVX-512BW: 32 int16 lanes, 32 pixels per iteration ----
+
+__attribute__((target("avx512f,avx512bw")))
+inline __m512i avx512Load32(const uint8_t* p) {
+    return _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+}
+
+template <int Weight>
+__attribute__((target("avx512f,avx512bw")))
+inline __m512i avx512Scale(__m512i v) {
+    if constexpr (Weight == 1) {
+        return v;
+    } else if constexpr (Weight == 2) {
+        return _mm512_add_epi16(v, v);
+    } else {
+        return _mm512_mullo_epi16(v, _mm512_set1_epi16(static_cast<int16_t>(Weight)));
+    }
+}
+
+template <typename Operator>
+__attribute__((target("avx512f,avx512bw")))
+inline __m512i avx512Smooth(__m512i top, __m512i middle, __m512i bottom) {
+    constexpr int w0 = smoothingWeight<Operator, 0>();
+    constexpr int w1 = smoothingWeight<Operator, 1>();
+    constexpr int w2 = smoothingWeight<Operator, 2>();
+    if constexpr (w0 == w2) {
+        return _mm512_add_epi16(avx512Scale<w0>(_mm512_add_epi16(top, bottom)), avx512Scale<w1>(middle));
+    } else {
+        return _mm512_add_epi16(_mm512_add_epi16(avx512Scale<w0>(top), avx512Scale<w1>(middle)),
+                                avx512Scale<w2>(bottom));
+    }
+}
+
+template <GradientNorm Norm>
+__attribute__((target("avx512f,avx512bw")))
+inline __m512i avx512Magnitude(__m512i gx, __m512i gy) {
+    if constexpr (Norm == GradientNorm::L2) {
+        __m512i lo = _mm512_unpacklo_epi16(gx, gy);
+        __m512i hi = _mm512_unpackhi_epi16(gx, gy);
+        __m512i magLo = _mm512_cvttps_epi32(_mm512_sqrt_ps(_mm512_cvtepi32_ps(_mm512_madd_epi16(lo, lo))));
+        __m512i magHi = _mm512_cvttps_epi32(_mm512_sqrt_ps(_mm512_cvtepi32_ps(_mm512_madd_epi16(hi, hi))));
+        return _mm512_packs_epi32(magLo, magHi);
+    } else if constexpr (Norm == GradientNorm::L1) {
+        return _mm512_adds_epi16(_mm512_abs_epi16(gx), _mm512_abs_epi16(gy));
+    } else {
+        return _mm512_max_epi16(_mm512_abs_epi16(gx), _mm512_abs_epi16(gy));
+    }
+}
+
+template <typename Operator, GradientNorm Norm, bool StorePlanes>
+__attribute__((target("avx512f,avx512bw")))
+void avx512Gradients(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                     uint8_t* output, int16_t* gxRow, int16_t* gyRow, int width) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m512i a0 = avx512Load32(above + x), a1 = avx512Load32(above + x + 1), a2 = avx512Load32(above + x + 2);
+        __m512i b0 = avx512Load32(below + x), b1 = avx512Load32(below + x + 1), b2 = avx512Load32(below + x + 2);
+
+        __m512i gx = _mm512_sub_epi16(avx512Smooth<Operator>(a2, avx512Load32(center + x + 2), b2),
+                                      avx512Smooth<Operator>(a0, avx512Load32(center + x), b0));
+        __m512i gy = avx512Smooth<Operator>(_mm512_sub_epi16(b0, a0), _mm512_sub_epi16(b1, a1),
+                                            _mm512_sub_epi16(b2, a2));
+        if constexpr (StorePlanes) {
+            _mm512_storeu_si512(gxRow + x, gx);
+            _mm512_storeu_si512(gyRow + x, gy);
+        }
+
+        __m512i magnitude = avx512Magnitude<Norm>(gx, gy);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + x), _mm512_cvtusepi16_epi8(magnitude));
+    }
+
+    avx2Gradients<Operator, Norm, StorePlanes>(above + x, center + x, below + x, output + x,
+                                               advance<StorePlanes>(gxRow, x), advance<StorePlanes>(gyRow, x),
+                                               width - x);
+}
+
+template <typename Operator, GradientNorm Norm>
+__attribute__((target("avx512f,avx512bw")))
+void avx512Row(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+               uint8_t* output, int width) {
+    avx512Gradients<Operator, Norm, false>(above, center, below, output, nullptr, nullptr, width);
+}
+
+template <typename Operator, GradientNorm Norm>
+constexpr GradientKernels::PlaneRowKernel avx512PlaneRow = avx512Gradients<Operator, Norm, true>;
+
+template <typename Operator, unsigned Operators, GradientNorm Norm>
+__attribute__((target("avx512f,avx512bw")))
+inline void avx512MultiStore(__m512i dxOuter, __m512i dxMiddle, __m512i dyOuter, __m512i dyMiddle,
+                             uint8_t* const* outputs, int x) {
+    if constexpr (inSet<Operator, Operators>()) {
+        __m512i gx = _mm512_add_epi16(avx512Scale<outerWeight<Operator>()>(dxOuter),
+                                      avx512Scale<middleWeight<Operator>()>(dxMiddle));
+        __m512i gy = _mm512_add_epi16(avx512Scale<outerWeight<Operator>()>(dyOuter),
+                                      avx512Scale<middleWeight<Operator>()>(dyMiddle));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(outputs[static_cast<int>(Operator::id)] + x),
+                            _mm512_cvtusepi16_epi8(avx512Magnitude<Norm>(gx, gy)));
+    }
+}
+
+template <unsigned Operators, GradientNorm Norm>
+__attribute__((target("avx512f,avx512bw")))
+void avx512MultiRow(const uint8_t* above, const uint8_t* center, const uint8_t* below,
+                    uint8_t* const* outputs, int width) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m512i a0 = avx512Load32(above + x), a1 = avx512Load32(above + x + 1), a2 = avx512Load32(above + x + 2);
+        __m512i b0 = avx512Load32(below + x), b1 = avx512Load32(below + x + 1), b2 = avx512Load32(below + x + 2);
+
+        __m512i dxOuter = _mm512_add_epi16(_mm512_sub_epi16(a2, a0), _mm512_sub_epi16(b2, b0));
+        __m512i dxMiddle = _mm512_sub_epi16(avx512Load32(center + x + 2), avx512Load32(center + x));
+        __m512i dyOuter = _mm512_add_epi16(_mm512_sub_epi16(b0, a0), _mm512_sub_epi16(b2, a2));
+        __m512i dyMiddle = _mm512_sub_epi16(b1, a1);
+        avx512MultiStore<SobelOperator, Operators, Norm>(dxOuter, dxMiddle, dyOuter, dyMiddle, outputs, x);
+        avx512MultiStore<PrewittOperator, Operators, Norm>(dxOuter, dxMiddle, dyOuter, dyMiddle, outputs, x);
+        avx512MultiStore<ScharrOperator, Operators, Norm>(dxOuter, dxMiddle, dyOuter, dyMiddle, outputs, x);
+    }
+
+    avx2MultiRow<Operators, Norm>(above + x, center + x, below + x, MultiOutputs(outputs, x).planes, width - x);
+}
+
+#endif // GRADIENT_KERNELS_X86
+
+// Variants supported by this CPU, ordered from the reference to the widest ISA
+const std::vector<GradientKernels::Variant>& supportedVariants() {
+    static const std::vector<GradientKernels::Variant> variants = [] {
+        std::vector<GradientKernels::Variant> list = {
+            {"scalar", ROW_KERNELS(scalarRow), ROW_KERNELS(scalarPlaneRow), MULTI_ROW_KERNELS(scalarMultiRow), false}};
+#if GRADIENT_KERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse2")) {
+            list.push_back({"sse2", ROW_KERNELS(sse2Row), ROW_KERNELS(sse2PlaneRow),
+                            MULTI_ROW_KERNELS(sse2MultiRow), false});
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            list.push_back({"avx2", ROW_KERNELS(avx2Row), ROW_KERNELS(avx2PlaneRow),
+                            MULTI_ROW_KERNELS(avx2MultiRow), true});
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("avx512f") &&
+            __builtin_cpu_supports("avx512bw")) {
+            list.push_back({"avx512", ROW_KERNELS(avx512Row), ROW_KERNELS(avx512PlaneRow),
+                            MULTI_ROW_KERNELS(avx512MultiRow), true});
+        }
+#endif
+        return list;
+    }();
+    return variants;
+}
+
+const GradientKernels::Variant* findVariant(const std::string& name) {
+    for (const auto& variant : supportedVariants()) {
+        if (name == variant.name) {
+            return &variant;
+        }
+    }
+    return nullptr;
+}
+
+// Widest supported ISA unless EDGE_DETECTOR_ISA names another supported variant. A name
+// that cannot be honoured is reported rather than silently replaced, since the override
+// exists to pin down which kernels run
+const GradientKernels::Variant* defaultVariant() {
+    const GradientKernels::Variant* widest = &supportedVariants().back();
+    const char* requested = std::getenv("EDGE_DETECTOR_ISA");
+    if (requested && *requested) {
+        if (const GradientKernels::Variant* variant = findVariant(requested)) {
+            return variant;
+        }
+        std::string supported;
+        for (const auto& variant : supportedVariants()) {
+            supported += (supported.empty() ? "" : ", ") + std::string(variant.name);
+        }
+        std::cerr << "Warning: EDGE_DETECTOR_ISA=" << requested << " is unknown or unsupported on this CPU "
+                  << "(supported: " << supported << "); using " << widest->name << std::endl;
+    }
+    return widest;
+}
+
+std::atomic<const GradientKernels::Variant*>& activeVariant() {
+    static std::atomic<const GradientKernels::Variant*> variant{defaultVariant()};
+    return variant;
+}
+
+} // namespace
+
+const uint8_t* GradientKernels::squareRootTable() {
+    static const std::array<uint8_t, 255 * 255> table = [] {
+        std::array<uint8_t, 255 * 255> values{};
+        for (int root = 0; root < 255; ++root) {
+            for (int n = root * root; n < (root + 1) * (root + 1); ++n) {
+                values[n] = static_cast<uint8_t>(root);
+            }
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+void GradientKernels::orientationRow(const int16_t* gx, const int16_t* gy, uint8_t* output, int width, int bins) {
+    // tan(22.5°) in Q15: bins change where one component exceeds the other by this factor
+    constexpr int TAN_22_5 = 13573;
+    const uint8_t mask = bins == 4 ? 3 : 7;
+
+    for (int x = 0; x < width; ++x) {
+        int dx = gx[x], dy = gy[x];
+        int ax = std::abs(dx), ay = std::abs(dy);
+        uint8_t bin;
+        if ((ay << 15) <= ax * TAN_22_5) {
+            bin = dx >= 0 ? 0 : 4;
+        } else if ((ax << 15) <= ay * TAN_22_5) {
+            bin = dy > 0 ? 2 : 6;
+        } else if (dy > 0) {
+            bin = dx > 0 ? 1 : 3;
+        } else {
+            bin = dx < 0 ? 5 : 7;
+        }
+        output[x] = bin & mask;
+    }
+}
+
+const GradientKernels::Variant& GradientKernels::active() {
+    return *activeVariant().load(std::memory_order_relaxed);
+}
+
+std::vector<GradientKernels::Variant> GradientKernels::available() {
+    return supportedVariants();
+}
+
+void GradientKernels::select(const std::string& name) {
+    const Variant* variant = findVariant(name);
+    if (!variant) {
+        throw std::invalid_argument("Gradient kernel variant not available on this CPU: " + name);
+    }
+    activeVariant().store(variant, std::memory_order_relaxed);
+}
@@ -0,0 +1,109 @@
+#include "Image.h"
+#include "GradientKernels.h"
+#include <algorithm>
+
+// Same target-attribute scheme as GradientKernels.cpp: one portable binary
+// carries the AVX2 path and picks it at runtime
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define GRAYSCALE_X86 1
+#include <immintrin.h>
+#else
+#define GRAYSCALE_X86 0
+#endif
+
+namespace {
+
+// Luma weights in Q16. Each set sums to 65536, so white stays 255 and gray pixels
+// keep their value; the result is truncated like the original double formula
+struct Weights {
+    int r, g, b;
+};
+
+constexpr Weights weightsFor(LumaWeights standard) {
+    return standard == LumaWeights::BT709 ? Weights{13933, 46871, 4732}   // 0.2126, 0.7152, 0.0722
+                                          : Weights{19595, 38470, 7471};  // 0.299, 0.587, 0.114
+}
+
+template <int Channels>
+void scalarLuma(const uint8_t* source, uint8_t* destination, size_t pixelCount, Weights w) {
+    for (size_t i = 0; i < pixelCount; ++i) {
+        const uint8_t* pixel = source + i * Channels;
+        destination[i] = static_cast<uint8_t>((w.r * pixel[0] + w.g * pixel[1] + w.b * pixel[2]) >> 16);
+    }
+}
+
+#if GRAYSCALE_X86
+
+// 32 pixels per iteration. pshufb spreads each pixel into the 16-bit pairs (r, g)
+// and (b, g) and pmaddwd applies the weights; the green weight exceeds int16, so
+// it is split across both pairs. Everything stays within 128-bit lanes: a lane
+// holds 4 pixels, loaded from 12 (RGB) or 16 (RGBA) consecutive bytes.
+template <int Channels>
+__attribute__((target("avx2")))
+void avx2Luma(const uint8_t* source, uint8_t* destination, size_t pixelCount, Weights w) {
+    constexpr int P = Channels;  // Byte stride between pixels
+    const __m256i redGreen = _mm256_setr_epi8(
+        0, -1, 1, -1, P, -1, P + 1, -1, 2 * P, -1, 2 * P + 1, -1, 3 * P, -1, 3 * P + 1, -1,
+        0, -1, 1, -1, P, -1, P + 1, -1, 2 * P, -1, 2 * P + 1, -1, 3 * P, -1, 3 * P + 1, -1);
+    const __m256i blueGreen = _mm256_setr_epi8(
+        2, -1, 1, -1, P + 2, -1, P + 1, -1, 2 * P + 2, -1, 2 * P + 1, -1, 3 * P + 2, -1, 3 * P + 1, -1,
+        2, -1, 1, -1, P + 2, -1, P + 1, -1, 2 * P + 2, -1, 2 * P + 1, -1, 3 * P + 2, -1, 3 * P + 1, -1);
+    int greenLow = std::min(w.g, 32767);
+    const __m256i redGreenWeights = _mm256_set1_epi32((greenLow << 16) | w.r);
+    const __m256i blueGreenWeights = _mm256_set1_epi32(((w.g - greenLow) << 16) | w.b);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    // The last 16-byte load of an iteration starts at pixel i + 28; for RGB it reads
+    // 4 bytes past the pixels it uses, which must still lie inside the source
+    size_t i = 0;
+    for (; (i + 28) * Channels + 16 <= pixelCount * Channels; i += 32) {
+        __m256i luma[4];
+        for (int quarter = 0; quarter < 4; ++quarter) {
+            const uint8_t* p = source + (i + quarter * 8) * Channels;
+            __m256i pixels = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4 * Channels)), 1);
+            __m256i sum = _mm256_add_epi32(
+                _mm256_madd_epi16(_mm256_shuffle_epi8(pixels, redGreen), redGreenWeights),
+                _mm256_madd_epi16(_mm256_shuffle_epi8(pixels, blueGreen), blueGreenWeights));
+            luma[quarter] = _mm256_srli_epi32(sum, 16);
+        }
+
+        // Packs interleave lanes; the permute restores pixel order
+        __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(luma[0], luma[1]),
+                                             _mm256_packus_epi32(luma[2], luma[3]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+
+    scalarLuma<Channels>(source + i * Channels, destination + i, pixelCount - i, w);
+}
+
+#endif // GRAYSCALE_X86
+
+// Dispatch follows the active gradient kernel variant, so EDGE_DETECTOR_ISA and
+// GradientKernels::select() pin grayscale conversion too. Variants using AVX2 are only
+// offered on CPUs that support it
+template <int Channels>
+void convertPixels(const uint8_t* source, uint8_t* destination, size_t pixelCount, Weights w) {
+#if GRAYSCALE_X86
+    if (GradientKernels::active().avx2) {
+        avx2Luma<Channels>(source, destination, pixelCount, w);
+        return;
+    }
+#endif
+    scalarLuma<Channels>(source, destination, pixelCount, w);
+}
+
+} // namespace
+
+void Image::convertToGrayscale(const uint8_t* source, uint8_t* destination,
+                               size_t pixelCount, int channels, LumaWeights luma) {
+    if (channels == 1) {
+        std::copy(source, source + pixelCount, destination);
+    } else if (channels == 3) {
+        convertPixels<3>(source, destination, pixelCount, weightsFor(luma));
+    } else {
+        // RGBA: alpha is ignored
+        convertPixels<4>(source, destination, pixelCount, weightsFor(luma));
+    }
+}
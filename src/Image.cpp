@@ -1,19 +1,24 @@
 #include "Image.h"
+#include "MappedFile.h"
+#include "PnmIO.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
 
 #include <iostream>
 #include <stdexcept>
 #include <filesystem>
+#include <fstream>
 #include <limits>
+#include <algorithm>
+#include <cctype>
 
-// STB Image Library integration for cross-platform image I/O
+// STB Image Library integration for cross-platform image decoding
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
 
 // Image Constructor with validations to ensure data integrity for image processing
 Image::Image(std::vector<uint8_t> data, int width, int height, int channels) 
-    : data(std::move(data)), width(width), height(height), channels(channels) {
+    : width(width), height(height), channels(channels) {
     
     // Basic validation
     if (width <= 0 || height <= 0 || channels <= 0) {
@@ -21,54 +26,66 @@ Image::Image(std::vector<uint8_t> data, int width, int height, int channels)
     }
     
     size_t expectedSize = static_cast<size_t>(width) * height * channels;
-    if (this->data.size() != expectedSize) {
+    if (data.size() != expectedSize) {
         throw std::invalid_argument("Data size doesn't match dimensions");
     }
+
+    // Move the vector into shared storage; the aliasing pointer avoids copying pixels
+    auto storage = std::make_shared<std::vector<uint8_t>>(std::move(data));
+    pixels = std::shared_ptr<const uint8_t>(storage, storage->data());
 }
 
+// Adopting constructor: takes shared ownership of an externally allocated buffer
+Image::Image(std::shared_ptr<const uint8_t> pixels, int width, int height, int channels)
+    : pixels(std::move(pixels)), width(width), height(height), channels(channels) {
 
-Image Image::loadFromFile(const std::string& filepath) {
-    // Validate file path
-    if (filepath.empty()) {
-        throw std::invalid_argument("File path cannot be empty");
+    if (width <= 0 || height <= 0 || channels <= 0) {
+        throw std::invalid_argument("Invalid image dimensions or channel count");
     }
 
-    // Check file existence and permissions
-    std::error_code ec;
-    if (!std::filesystem::exists(filepath, ec)) {
-        throw std::runtime_error("File does not exist: " + filepath);
-    }
-    
-    if (ec) {
-        throw std::runtime_error("Error accessing file: " + filepath + " (" + ec.message() + ")");
+    if (!this->pixels) {
+        throw std::invalid_argument("Pixel buffer cannot be null");
     }
+}
 
-    // Image property variables
-    int width, height, channels;
-    
-    // Load image using STB with error checking
-    unsigned char* raw_data = stbi_load(filepath.c_str(), &width, &height, &channels, 0);
+namespace {
+
+// Detects JPEG by its SOI marker rather than the extension
+bool isJpeg(const uint8_t* bytes, size_t size) {
+    return size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xD8;
+}
+
+bool isJpegFile(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    uint8_t magic[2] = {};
+    return file.read(reinterpret_cast<char*>(magic), 2) && isJpeg(magic, 2);
+}
+
+// Validates an STB decode result and takes ownership of its buffer: it is freed on
+// any error, or adopted by the returned Image without copying the pixels
+// @param source Names the input in error messages
+Image adoptDecoded(unsigned char* raw_data, int width, int height, int channels, const std::string& source) {
     if (!raw_data) {
         std::string stb_error = stbi_failure_reason() ? stbi_failure_reason() : "Unknown STB error";
-        throw std::runtime_error("Failed to load image '" + filepath + "': " + stb_error);
+        throw std::runtime_error("Failed to load image " + source + ": " + stb_error);
     }
+    std::shared_ptr<const uint8_t> pixels(raw_data, [](const uint8_t* buffer) {
+        stbi_image_free(const_cast<uint8_t*>(buffer));
+    });
 
     // Validate image dimensions
     if (width <= 0 || height <= 0) {
-        stbi_image_free(raw_data);
         throw std::runtime_error("Invalid image dimensions: " + std::to_string(width) + "x" + std::to_string(height));
     }
 
     // Check for edge detection minimum requirements
     if (width < 3 || height < 3) {
-        stbi_image_free(raw_data);
         throw std::runtime_error("Image too small for edge detection (minimum 3x3): " + 
                                 std::to_string(width) + "x" + std::to_string(height));
     }
 
     // Validate channel count
     if (channels < 1 || channels > 4) {
-        stbi_image_free(raw_data);
         throw std::runtime_error("Unsupported channel count: " + std::to_string(channels) + 
                                 " (supported: 1-4 channels)");
     }
@@ -77,28 +94,116 @@ Image Image::loadFromFile(const std::string& filepath) {
     size_t dataSize = static_cast<size_t>(width) * height * channels;
     constexpr size_t MAX_IMAGE_SIZE = 100 * 1024 * 1024; // 100MB limit
     if (dataSize > MAX_IMAGE_SIZE) {
-        stbi_image_free(raw_data);
         throw std::runtime_error("Image too large: " + std::to_string(dataSize) + 
                                 " bytes (limit: " + std::to_string(MAX_IMAGE_SIZE) + ")");
     }
+    return Image(std::move(pixels), width, height, channels);
+}
+
+} // namespace
+
+Image Image::loadFromFile(const std::string& filepath, const LoadOptions& options) {
+    // Validate file path
+    if (filepath.empty()) {
+        throw std::invalid_argument("File path cannot be empty");
+    }
+
+    // Check file existence and permissions
+    std::error_code ec;
+    if (!std::filesystem::exists(filepath, ec)) {
+        throw std::runtime_error("File does not exist: " + filepath);
+    }
+    
+    if (ec) {
+        throw std::runtime_error("Error accessing file: " + filepath + " (" + ec.message() + ")");
+    }
+
+    // Uncompressed Netpbm files need no decoding: map them and point into the mapping
+    if (PnmIO::hasPnmExtension(filepath)) {
+        Profiler::Scope scope("map", 0, filepath);
+        auto mapping = MappedFile::openRead(filepath);
+        PnmHeader header = PnmIO::parseHeader(mapping->data(), mapping->size());
+        Image image = fromMapping(std::move(mapping), header.dataOffset, header.width, header.height, header.channels);
+        return options.grayscale ? image.toGrayscale(options.luma) : image;
+    }
+
+    // Image property variables
+    int width, height, channels;
+    
+    // Load image using STB with error checking
+    Profiler::Scope scope("decode", 0, filepath);
+    // A JPEG stores BT.601 luma as its own plane: asking stb for one component
+    // decodes just that plane. Other formats are converted after decoding, since
+    // stb's own RGB-to-gray formula differs from convertToGrayscale
+    bool lumaPlane = options.grayscale && options.luma == LumaWeights::BT601 && isJpegFile(filepath);
+    unsigned char* raw_data = stbi_load(filepath.c_str(), &width, &height, &channels, lumaPlane ? 1 : 0);
+    // stb reports the file's channel count, not the requested one
+    Image image = adoptDecoded(raw_data, width, height, lumaPlane ? 1 : channels, "'" + filepath + "'");
+
+    auto fileSize = std::filesystem::file_size(filepath, ec);
+    scope.setBytes(image.getDataSize() + (ec ? 0 : static_cast<size_t>(fileSize)));
+    return options.grayscale ? image.toGrayscale(options.luma) : image;
+}
+
+Image Image::loadFromMemory(ByteSpan encoded, const LoadOptions& options) {
+    if (encoded.empty()) {
+        throw std::invalid_argument("Encoded image data cannot be empty");
+    }
+    if (encoded.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("Encoded image too large: " + std::to_string(encoded.size()) + " bytes");
+    }
+
+    Profiler::Scope scope("decode", encoded.size());
+    bool lumaPlane = options.grayscale && options.luma == LumaWeights::BT601 && isJpeg(encoded.data(), encoded.size());
+    int width, height, channels;
+    unsigned char* raw_data = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()),
+                                                    &width, &height, &channels, lumaPlane ? 1 : 0);
+    Image image = adoptDecoded(raw_data, width, height, lumaPlane ? 1 : channels, "from memory");
+    scope.setBytes(encoded.size() + image.getDataSize());
+    return options.grayscale ? image.toGrayscale(options.luma) : image;
+}
+
+Image Image::loadRaw(const std::string& filepath, int width, int height, int channels) {
+    if (filepath.empty()) {
+        throw std::invalid_argument("File path cannot be empty");
+    }
+    return fromMapping(MappedFile::openRead(filepath), 0, width, height, channels);
+}
+
+Image Image::fromMapping(std::shared_ptr<MappedFile> mapping, size_t dataOffset,
+                         int width, int height, int channels) {
+    if (width < 3 || height < 3) {
+        throw std::runtime_error("Image too small for edge detection (minimum 3x3): " +
+                                std::to_string(width) + "x" + std::to_string(height));
+    }
+    if (channels < 1 || channels > 4) {
+        throw std::runtime_error("Unsupported channel count: " + std::to_string(channels) +
+                                " (supported: 1-4 channels)");
+    }
 
-    // Copy raw data into a std::vector
-    std::vector<uint8_t> pixel_data(raw_data, raw_data + dataSize);
+    // Mapped pixels are paged in on demand, so the decode size limit does not apply
+    size_t dataSize = static_cast<size_t>(width) * height * channels;
+    if (dataOffset > mapping->size() || mapping->size() - dataOffset < dataSize) {
+        throw std::runtime_error("File too short for " + std::to_string(width) + "x" + std::to_string(height) +
+                                "x" + std::to_string(channels) + " pixels");
+    }
+    if (dataOffset == 0 && mapping->size() != dataSize) {
+        throw std::runtime_error("Raw file size mismatch. Expected: " + std::to_string(dataSize) +
+                                ", Actual: " + std::to_string(mapping->size()));
+    }
 
-    // Free the original STB data 
-    stbi_image_free(raw_data);
-              
-    // Return the Image object
-    return Image(pixel_data, width, height, channels);
+    // The aliasing pointer keeps the whole mapping alive while any Image shares the pixels
+    const uint8_t* first = mapping->data() + dataOffset;
+    return Image(std::shared_ptr<const uint8_t>(std::move(mapping), first), width, height, channels);
 }
 
-void Image::saveToFile(const std::string& filepath) const {
+void Image::saveToFile(const std::string& filepath, const PngOptions& options) const {
     // Validate parameters
     if (filepath.empty()) {
         throw std::invalid_argument("File path cannot be empty");
     }
 
-    if (data.empty() || width <= 0 || height <= 0) {
+    if (!pixels || width <= 0 || height <= 0) {
         throw std::runtime_error("Cannot save invalid image data");
     }
 
@@ -115,31 +220,70 @@ void Image::saveToFile(const std::string& filepath) const {
         }
     }
 
-    // Validate data consistency
-    size_t expectedSize = static_cast<size_t>(width) * height * channels;
-    if (data.size() != expectedSize) {
-        throw std::runtime_error("Image data size mismatch. Expected: " + 
-                                std::to_string(expectedSize) + ", Actual: " + 
-                                std::to_string(data.size()));
+    // Uncompressed formats are copied straight into a pre-sized mapping
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    if (PnmIO::hasPnmExtension(filepath)) {
+        Profiler::Scope scope("write", getDataSize(), filepath);
+        saveMapped(filepath, PnmIO::formatHeader(width, height, channels));
+        return;
+    }
+    if (extension == ".raw") {
+        Profiler::Scope scope("write", getDataSize(), filepath);
+        saveMapped(filepath, "");
+        return;
     }
 
     // Save as PNG (for both grayscale and color)
-    int result = stbi_write_png(filepath.c_str(), width, height, channels, 
-                               data.data(), width * channels);
-    if (!result) {
+    std::vector<uint8_t> png = PngEncoder::encode(view(), options);
+    Profiler::Scope scope("write", png.size(), filepath);
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    if (!file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()))) {
         throw std::runtime_error("Failed to save image: " + filepath + 
                                 " (possible: disk full, permission denied, or invalid path)");
     }
+}
+
+void Image::encodePng(std::vector<uint8_t>& output, const PngOptions& options) const {
+    PngEncoder::encodeInto(view(), output, options);
+}
 
+void Image::encodeToCallback(const PngEncoder::WriteFunction& write, const PngOptions& options) const {
+    PngEncoder::encodeToCallback(view(), write, options);
 }
 
-Image Image::toGrayscale() const {
+void Image::saveMapped(const std::string& filepath, const std::string& header) const {
+    auto mapping = MappedFile::create(filepath, header.size() + getDataSize());
+    uint8_t* destination = mapping->mutableData();
+    std::copy(header.begin(), header.end(), destination);
+    std::copy(pixels.get(), pixels.get() + getDataSize(), destination + header.size());
+    mapping->commit();
+}
+
+LumaWeights Image::parseLuma(const std::string& name) {
+    std::string lowerName;
+    for (char c : name) {
+        if (c != '.') {
+            lowerName += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+    }
+    if (lowerName == "bt601") {
+        return LumaWeights::BT601;
+    }
+    if (lowerName == "bt709") {
+        return LumaWeights::BT709;
+    }
+    throw std::invalid_argument("Unknown luma standard: " + name +
+                                ". Supported standards: 'BT601', 'BT709' (case-insensitive)");
+}
+
+Image Image::toGrayscale(LumaWeights luma, unsigned threads) const {
     // Validate input
-    if (data.empty() || width <= 0 || height <= 0) {
+    if (!pixels || width <= 0 || height <= 0) {
         throw std::runtime_error("Cannot convert invalid image to grayscale");
     }
 
-    // If the image is already grayscale, return a copy of the current object
+    // If the image is already grayscale, return a copy sharing the same pixels
     if (channels == 1) {
         return *this;
     }
@@ -150,27 +294,25 @@ Image Image::toGrayscale() const {
                                 "Current channels: " + std::to_string(channels));
     }
 
-    // Validate data size consistency
-    size_t expectedSize = static_cast<size_t>(width) * height * channels;
-    if (data.size() != expectedSize) {
-        throw std::runtime_error("Image data corrupted. Expected size: " +
-                                std::to_string(expectedSize) + ", Actual: " +
-                                std::to_string(data.size()));
-    }
-
     // Create a new vector to hold the grayscale pixel data
-    std::vector<uint8_t> gray_data(width * height);
-
-    // Convert RGB to grayscale using the luminosity formula
-    for (int i = 0; i < width * height; ++i) {
-        uint8_t r = data[static_cast<size_t>(i) * channels + 0];
-        uint8_t g = data[static_cast<size_t>(i) * channels + 1];
-        uint8_t b = data[static_cast<size_t>(i) * channels + 2];
-        
-        // Luminosity formula
-        gray_data[i] = static_cast<uint8_t>(0.299 * r + 0.587 * g + 0.114 * b);
+    Profiler::Scope scope("grayscale");
+    std::vector<uint8_t> gray_data(static_cast<size_t>(width) * height);
+    ThreadPool* pool = threads == 1 ? nullptr : &ThreadPool::shared(threads);
+    size_t blockCount = pool ? std::min<size_t>(pool->size(), height) : 1;
+    if (blockCount <= 1) {
+        convertToGrayscale(pixels.get(), gray_data.data(), gray_data.size(), channels, luma);
+    } else {
+        // Contiguous row blocks, one per thread
+        pool->parallelFor(blockCount, [&](size_t block) {
+            size_t firstRow = static_cast<size_t>(height) * block / blockCount;
+            size_t lastRow = static_cast<size_t>(height) * (block + 1) / blockCount;
+            size_t firstPixel = firstRow * width;
+            convertToGrayscale(pixels.get() + firstPixel * channels, gray_data.data() + firstPixel,
+                               (lastRow - firstRow) * width, channels, luma);
+        });
     }
 
     // Use the new constructor to create and return the grayscale Image object
-    return Image(gray_data, width, height, 1);
-}
\ No newline at end of file
+    scope.setBytes(getDataSize() + gray_data.size());
+    return Image(std::move(gray_data), width, height, 1);
+}
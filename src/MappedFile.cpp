@@ -0,0 +1,139 @@
+#include "MappedFile.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::string systemError(const std::string& action, const std::string& filepath) {
+    return action + " " + filepath + " (" + std::strerror(errno) + ")";
+}
+
+// Closes the descriptor on scope exit; the mapping stays valid after close()
+struct FileDescriptor {
+    int fd;
+    ~FileDescriptor() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+};
+
+} // namespace
+
+MappedFile::MappedFile(uint8_t* bytes, size_t length, bool writable, std::string filepath,
+                       std::string temporaryPath)
+    : bytes(bytes), length(length), writable(writable), filepath(std::move(filepath)),
+      temporaryPath(std::move(temporaryPath)) {}
+
+MappedFile::~MappedFile() {
+    if (bytes) {
+        ::munmap(bytes, length);
+    }
+    // An uncommitted result is discarded, leaving the target as it was
+    if (!temporaryPath.empty()) {
+        ::unlink(temporaryPath.c_str());
+    }
+}
+
+std::shared_ptr<MappedFile> MappedFile::openRead(const std::string& filepath) {
+    FileDescriptor file{::open(filepath.c_str(), O_RDONLY)};
+    if (file.fd < 0) {
+        throw std::runtime_error(systemError("Cannot open file:", filepath));
+    }
+
+    struct stat status;
+    if (::fstat(file.fd, &status) != 0) {
+        throw std::runtime_error(systemError("Cannot stat file:", filepath));
+    }
+    if (status.st_size == 0) {
+        throw std::runtime_error("File is empty: " + filepath);
+    }
+
+    size_t length = static_cast<size_t>(status.st_size);
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, file.fd, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error(systemError("Cannot map file:", filepath));
+    }
+
+    // Pixels are consumed top to bottom
+    ::madvise(mapping, length, MADV_SEQUENTIAL);
+    return std::shared_ptr<MappedFile>(new MappedFile(static_cast<uint8_t*>(mapping), length, false, filepath, ""));
+}
+
+std::shared_ptr<MappedFile> MappedFile::create(const std::string& filepath, size_t size) {
+    if (size == 0) {
+        throw std::invalid_argument("Mapped file size must be positive");
+    }
+
+    // The target may back a read mapping of this or another process; truncating it in
+    // place would turn their next access into SIGBUS, so the result goes to a new file
+    static std::atomic<unsigned> nextTemporary{0};
+    std::string temporaryPath =
+        filepath + ".tmp" + std::to_string(::getpid()) + "_" + std::to_string(nextTemporary++);
+    FileDescriptor file{::open(temporaryPath.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644)};
+    if (file.fd < 0) {
+        throw std::runtime_error(systemError("Cannot create file:", filepath));
+    }
+    auto fail = [&](const std::string& action) {
+        std::string message = systemError(action, filepath);
+        ::unlink(temporaryPath.c_str());
+        throw std::runtime_error(message);
+    };
+
+    // Reserve the blocks up front so running out of disk fails here, not as SIGBUS on a store
+    int error = ::posix_fallocate(file.fd, 0, static_cast<off_t>(size));
+    if (error == EINVAL || error == EOPNOTSUPP) {
+        error = ::ftruncate(file.fd, static_cast<off_t>(size)) == 0 ? 0 : errno;
+    }
+    if (error != 0) {
+        errno = error;
+        fail("Cannot allocate file:");
+    }
+
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+    if (mapping == MAP_FAILED) {
+        fail("Cannot map file:");
+    }
+    return std::shared_ptr<MappedFile>(
+        new MappedFile(static_cast<uint8_t*>(mapping), size, true, filepath, std::move(temporaryPath)));
+}
+
+uint8_t* MappedFile::mutableData() {
+    if (!writable) {
+        throw std::logic_error("Mapping is read-only: " + filepath);
+    }
+    return bytes;
+}
+
+void MappedFile::commit() {
+    if (!writable || temporaryPath.empty()) {
+        throw std::logic_error("Mapping has nothing to commit: " + filepath);
+    }
+
+    // Write errors of a mapping only surface through msync and munmap
+    int synced = ::msync(bytes, length, MS_SYNC);
+    int syncError = errno;
+    int unmapped = ::munmap(bytes, length);
+    bytes = nullptr;
+    if (synced != 0 || unmapped != 0) {
+        errno = synced != 0 ? syncError : errno;
+        std::string message = systemError("Cannot write file:", filepath);
+        ::unlink(temporaryPath.c_str());
+        temporaryPath.clear();
+        throw std::runtime_error(message);
+    }
+
+    if (::rename(temporaryPath.c_str(), filepath.c_str()) != 0) {
+        std::string message = systemError("Cannot replace file:", filepath);
+        ::unlink(temporaryPath.c_str());
+        temporaryPath.clear();
+        throw std::runtime_error(message);
+    }
+    temporaryPath.clear();
+}
@@ -0,0 +1,501 @@
+#include "PngEncoder.h"
+#include "Image.h"
+#include "ThreadPool.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+
+// Uncompressed bytes per independently deflated chunk; large enough that the
+// 32KB window reset at chunk boundaries costs well under 1% of output size
+constexpr size_t CHUNK_BYTES = 256 * 1024;
+
+constexpr size_t WINDOW_SIZE = 32768;
+constexpr int MIN_MATCH = 3;
+constexpr int MAX_MATCH = 258;
+constexpr int HASH_BITS = 15;
+constexpr size_t MAX_STORED_BLOCK = 65535;
+
+// Hash chain depth and early-exit match length per compression level (index 0 unused)
+constexpr int CHAIN_LIMITS[10] = {0, 4, 8, 16, 16, 32, 64, 128, 256, 1024};
+constexpr int NICE_LENGTHS[10] = {0, 16, 32, 64, 64, 128, 258, 258, 258, 258};
+
+// Slicing-by-8 tables: table[k][n] is the CRC of byte n followed by k zero bytes
+using CrcTables = std::array<std::array<uint32_t, 256>, 8>;
+
+const CrcTables& crcTables() {
+    static const CrcTables tables = [] {
+        CrcTables entries{};
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            entries[0][n] = c;
+        }
+        for (uint32_t n = 0; n < 256; ++n) {
+            for (int k = 1; k < 8; ++k) {
+                entries[k][n] = entries[0][entries[k - 1][n] & 0xFF] ^ (entries[k - 1][n] >> 8);
+            }
+        }
+        return entries;
+    }();
+    return tables;
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    const CrcTables& t = crcTables();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (; size >= 8; data += 8, size -= 8) {
+        uint32_t low = crc ^ (static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+                              static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+    }
+    for (; size > 0; ++data, --size) {
+        crc = t[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+constexpr uint32_t ADLER_BASE = 65521;
+
+uint32_t adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1, b = 0;
+    while (size > 0) {
+        // 5552 is the largest run that cannot overflow 32-bit sums before the modulo
+        size_t run = std::min<size_t>(size, 5552);
+        for (size_t i = 0; i < run; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
+        data += run;
+        size -= run;
+    }
+    return (b << 16) | a;
+}
+
+// Checksum of A followed by B from the checksums of both parts (as zlib's adler32_combine)
+uint32_t adler32Combine(uint32_t adlerA, uint32_t adlerB, size_t sizeB) {
+    uint32_t remainder = static_cast<uint32_t>(sizeB % ADLER_BASE);
+    uint32_t sum1 = adlerA & 0xFFFF;
+    uint32_t sum2 = static_cast<uint32_t>((static_cast<uint64_t>(remainder) * sum1) % ADLER_BASE);
+    sum1 += (adlerB & 0xFFFF) + ADLER_BASE - 1;
+    sum2 += (adlerA >> 16) + (adlerB >> 16) + ADLER_BASE - remainder;
+    if (sum1 >= ADLER_BASE) sum1 -= ADLER_BASE;
+    if (sum1 >= ADLER_BASE) sum1 -= ADLER_BASE;
+    if (sum2 >= (ADLER_BASE << 1)) sum2 -= (ADLER_BASE << 1);
+    if (sum2 >= ADLER_BASE) sum2 -= ADLER_BASE;
+    return (sum2 << 16) | sum1;
+}
+
+void appendBigEndian(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Deflate bit stream writer (bits are packed least significant first)
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    void putBits(uint32_t bits, int count) {
+        buffer |= static_cast<uint64_t>(bits) << bitCount;
+        bitCount += count;
+        while (bitCount >= 8) {
+            out.push_back(static_cast<uint8_t>(buffer));
+            buffer >>= 8;
+            bitCount -= 8;
+        }
+    }
+
+    // Huffman codes are defined most significant bit first
+    void putCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        putBits(reversed, length);
+    }
+
+    void alignToByte() {
+        if (bitCount > 0) {
+            putBits(0, 8 - bitCount);
+        }
+    }
+
+private:
+    std::vector<uint8_t>& out;
+    uint64_t buffer = 0;
+    int bitCount = 0;
+};
+
+// Fixed Huffman literal/length code (RFC 1951, 3.2.6)
+void putLiteralLength(BitWriter& writer, int symbol) {
+    if (symbol < 144) {
+        writer.putCode(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        writer.putCode(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        writer.putCode(symbol - 256, 7);
+    } else {
+        writer.putCode(0xC0 + symbol - 280, 8);
+    }
+}
+
+constexpr int LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr int LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                  3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+constexpr int DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                   257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                   8193, 12289, 16385, 24577};
+constexpr int DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+void putMatch(BitWriter& writer, int length, int distance) {
+    int lengthCode = 28;
+    while (LENGTH_BASE[lengthCode] > length) {
+        --lengthCode;
+    }
+    putLiteralLength(writer, 257 + lengthCode);
+    writer.putBits(length - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+
+    int distanceCode = 29;
+    while (DISTANCE_BASE[distanceCode] > distance) {
+        --distanceCode;
+    }
+    writer.putCode(distanceCode, 5);
+    writer.putBits(distance - DISTANCE_BASE[distanceCode], DISTANCE_EXTRA[distanceCode]);
+}
+
+uint32_t hash3(const uint8_t* p) {
+    uint32_t value = (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Appends data as non-final stored blocks; the stream must be byte-aligned
+void deflateStored(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    do {
+        size_t blockSize = std::min(size, MAX_STORED_BLOCK);
+        out.push_back(0x00);  // BFINAL = 0, BTYPE = 00
+        out.push_back(static_cast<uint8_t>(blockSize));
+        out.push_back(static_cast<uint8_t>(blockSize >> 8));
+        out.push_back(static_cast<uint8_t>(~blockSize));
+        out.push_back(static_cast<uint8_t>(~blockSize >> 8));
+        out.insert(out.end(), data, data + blockSize);
+        data += blockSize;
+        size -= blockSize;
+    } while (size > 0);
+}
+
+// Appends data as one non-final fixed Huffman block (LZ77 over a hash chain),
+// followed by an empty stored block that returns the stream to a byte boundary
+void deflateFixed(const uint8_t* data, size_t size, int level, std::vector<uint8_t>& out) {
+    BitWriter writer(out);
+    writer.putBits(0, 1);  // BFINAL = 0
+    writer.putBits(1, 2);  // BTYPE = 01 (fixed Huffman)
+
+    std::vector<int32_t> head(size_t(1) << HASH_BITS, -1);
+    std::vector<int32_t> previous(WINDOW_SIZE, -1);
+    int chainLimit = CHAIN_LIMITS[level];
+    int niceLength = NICE_LENGTHS[level];
+
+    auto insert = [&](size_t position) {
+        uint32_t hash = hash3(data + position);
+        previous[position % WINDOW_SIZE] = head[hash];
+        head[hash] = static_cast<int32_t>(position);
+    };
+
+    size_t position = 0;
+    while (position < size) {
+        int bestLength = 0;
+        int bestDistance = 0;
+
+        if (position + MIN_MATCH <= size) {
+            int maxLength = static_cast<int>(std::min<size_t>(MAX_MATCH, size - position));
+            int32_t candidate = head[hash3(data + position)];
+            for (int chain = 0; candidate >= 0 && chain < chainLimit && bestLength < maxLength; ++chain) {
+                size_t distance = position - static_cast<size_t>(candidate);
+                if (distance > WINDOW_SIZE) {
+                    break;
+                }
+                const uint8_t* a = data + position;
+                const uint8_t* b = data + candidate;
+                if (b[bestLength] == a[bestLength]) {
+                    int length = 0;
+                    while (length < maxLength && a[length] == b[length]) {
+                        ++length;
+                    }
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = static_cast<int>(distance);
+                        if (length >= niceLength) {
+                            break;
+                        }
+                    }
+                }
+                candidate = previous[static_cast<size_t>(candidate) % WINDOW_SIZE];
+            }
+            insert(position);
+        }
+
+        if (bestLength >= MIN_MATCH) {
+            putMatch(writer, bestLength, bestDistance);
+            // Fast levels skip hashing inside matches; this trades ratio for speed
+            size_t end = position + bestLength;
+            if (level > 3 || bestLength <= 8) {
+                for (size_t p = position + 1; p < end && p + MIN_MATCH <= size; ++p) {
+                    insert(p);
+                }
+            }
+            position = end;
+        } else {
+            putLiteralLength(writer, data[position]);
+            ++position;
+        }
+    }
+
+    putLiteralLength(writer, 256);  // End of block
+    writer.putBits(0, 1);           // Sync point: empty non-final stored block
+    writer.putBits(0, 2);
+    writer.alignToByte();
+    out.insert(out.end(), {0x00, 0x00, 0xFF, 0xFF});
+}
+
+int paethPredictor(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Writes the filter type byte and filtered bytes of one row; above is null for the first row
+void filterRow(PngFilter filter, const uint8_t* row, const uint8_t* above, size_t rowBytes,
+               int bytesPerPixel, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(filter);
+    uint8_t* filtered = out + 1;
+    size_t bpp = static_cast<size_t>(bytesPerPixel);
+
+    // The first row has no row above: Up becomes None, Average halves the left neighbour
+    // and Paeth reduces to Sub; handled by treating the missing row as zeros
+    std::vector<uint8_t> zeros;
+    if (!above && filter != PngFilter::None && filter != PngFilter::Sub) {
+        zeros.assign(rowBytes, 0);
+        above = zeros.data();
+    }
+
+    switch (filter) {
+        case PngFilter::Sub:
+            std::copy(row, row + std::min(bpp, rowBytes), filtered);
+            for (size_t i = bpp; i < rowBytes; ++i) {
+                filtered[i] = static_cast<uint8_t>(row[i] - row[i - bpp]);
+            }
+            break;
+        case PngFilter::Up:
+            for (size_t i = 0; i < rowBytes; ++i) {
+                filtered[i] = static_cast<uint8_t>(row[i] - above[i]);
+            }
+            break;
+        case PngFilter::Average:
+            for (size_t i = 0; i < rowBytes; ++i) {
+                int left = i >= bpp ? row[i - bpp] : 0;
+                filtered[i] = static_cast<uint8_t>(row[i] - ((left + above[i]) >> 1));
+            }
+            break;
+        case PngFilter::Paeth:
+            for (size_t i = 0; i < bpp && i < rowBytes; ++i) {
+                filtered[i] = static_cast<uint8_t>(row[i] - above[i]);
+            }
+            for (size_t i = bpp; i < rowBytes; ++i) {
+                filtered[i] = static_cast<uint8_t>(row[i] - paethPredictor(row[i - bpp], above[i], above[i - bpp]));
+            }
+            break;
+        default:
+            std::copy(row, row + rowBytes, filtered);
+            break;
+    }
+}
+
+// Sum of residuals read as signed bytes: the usual "minimum sum of absolute differences" heuristic
+size_t residualCost(const uint8_t* filtered, size_t rowBytes) {
+    size_t cost = 0;
+    for (size_t i = 0; i < rowBytes; ++i) {
+        cost += static_cast<size_t>(std::abs(static_cast<int8_t>(filtered[i])));
+    }
+    return cost;
+}
+
+void writeChunk(std::vector<uint8_t>& out, const char type[4], const uint8_t* data, size_t size) {
+    appendBigEndian(out, static_cast<uint32_t>(size));
+    size_t typeOffset = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    appendBigEndian(out, crc32(out.data() + typeOffset, size + 4));
+}
+
+// One independently compressed run of rows, already wrapped in an IDAT chunk
+struct EncodedPart {
+    std::vector<uint8_t> idat;
+    uint32_t adler = 0;
+    size_t filteredSize = 0;
+};
+
+EncodedPart encodePart(const ImageView& image, int firstRow, int lastRow, const PngOptions& options,
+                       bool withZlibHeader) {
+    size_t rowBytes = static_cast<size_t>(image.width) * image.channels;
+    std::vector<uint8_t> filtered((rowBytes + 1) * static_cast<size_t>(lastRow - firstRow));
+    std::vector<uint8_t> candidate(options.filter == PngFilter::Adaptive ? rowBytes + 1 : 0);
+
+    uint8_t* out = filtered.data();
+    for (int y = firstRow; y < lastRow; ++y, out += rowBytes + 1) {
+        const uint8_t* above = y > 0 ? image.row(y - 1) : nullptr;
+        if (options.filter != PngFilter::Adaptive) {
+            filterRow(options.filter, image.row(y), above, rowBytes, image.channels, out);
+            continue;
+        }
+
+        size_t bestCost = SIZE_MAX;
+        for (PngFilter filter : {PngFilter::None, PngFilter::Sub, PngFilter::Up,
+                                 PngFilter::Average, PngFilter::Paeth}) {
+            filterRow(filter, image.row(y), above, rowBytes, image.channels, candidate.data());
+            size_t cost = residualCost(candidate.data() + 1, rowBytes);
+            if (cost < bestCost) {
+                bestCost = cost;
+                std::copy(candidate.begin(), candidate.end(), out);
+            }
+        }
+    }
+
+    EncodedPart part;
+    part.filteredSize = filtered.size();
+    part.adler = adler32(filtered.data(), filtered.size());
+
+    // Chunk payload: optional zlib header, then deflate blocks ending on a byte boundary
+    std::vector<uint8_t> payload;
+    if (withZlibHeader) {
+        // CMF = deflate with 32KB window; FLG carries the level hint and the check bits
+        uint8_t flags = options.compressionLevel <= 1 ? 0x01 : options.compressionLevel <= 5 ? 0x5E
+                      : options.compressionLevel == 6 ? 0x9C : 0xDA;
+        payload = {0x78, flags};
+    }
+    size_t headerSize = payload.size();
+    if (options.compressionLevel > 0) {
+        deflateFixed(filtered.data(), filtered.size(), options.compressionLevel, payload);
+    }
+    // Fall back to stored blocks when LZ77 with fixed codes does not pay off
+    size_t storedSize = filtered.size() + 5 * ((filtered.size() + MAX_STORED_BLOCK - 1) / MAX_STORED_BLOCK);
+    if (options.compressionLevel == 0 || payload.size() - headerSize > storedSize) {
+        payload.resize(headerSize);
+        deflateStored(filtered.data(), filtered.size(), payload);
+    }
+
+    writeChunk(part.idat, "IDAT", payload.data(), payload.size());
+    return part;
+}
+
+} // namespace
+
+std::vector<uint8_t> PngEncoder::encode(const ImageView& image, const PngOptions& options) {
+    std::vector<uint8_t> png;
+    encodeInto(image, png, options);
+    return png;
+}
+
+void PngEncoder::encodeInto(const ImageView& image, std::vector<uint8_t>& output, const PngOptions& options) {
+    output.clear();
+    encodeToCallback(image, [&output](const uint8_t* data, size_t size) {
+        output.insert(output.end(), data, data + size);
+    }, options);
+}
+
+void PngEncoder::encodeToCallback(const ImageView& image, const WriteFunction& write, const PngOptions& options) {
+    if (options.compressionLevel < 0 || options.compressionLevel > 9) {
+        throw std::invalid_argument("PNG compression level must be 0-9, got " +
+                                    std::to_string(options.compressionLevel));
+    }
+    if (!image.data || image.width <= 0 || image.height <= 0 || image.channels < 1 || image.channels > 4) {
+        throw std::invalid_argument("Cannot encode invalid image data as PNG");
+    }
+
+    size_t rowBytes = static_cast<size_t>(image.width) * image.channels;
+    Profiler::Scope scope("encode");
+    int rowsPerPart = static_cast<int>(std::max<size_t>(1, CHUNK_BYTES / (rowBytes + 1)));
+    size_t partCount = (static_cast<size_t>(image.height) + rowsPerPart - 1) / rowsPerPart;
+
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    static const uint8_t COLOR_TYPES[5] = {0, 0, 4, 2, 6};  // Indexed by channel count
+    std::vector<uint8_t> header;
+    appendBigEndian(header, static_cast<uint32_t>(image.width));
+    appendBigEndian(header, static_cast<uint32_t>(image.height));
+    header.insert(header.end(), {8, COLOR_TYPES[image.channels], 0, 0, 0});
+    writeChunk(png, "IHDR", header.data(), header.size());
+    write(png.data(), png.size());
+    size_t written = png.size();
+
+    std::vector<EncodedPart> parts(partCount);
+    auto encodeIndex = [&](size_t index) {
+        int firstRow = static_cast<int>(index) * rowsPerPart;
+        int lastRow = std::min(image.height, firstRow + rowsPerPart);
+        Profiler::Scope chunkScope("encode_chunk", rowBytes * (lastRow - firstRow));
+        parts[index] = encodePart(image, firstRow, lastRow, options, index == 0);
+    };
+
+    // Parts are handed out in order; single-threaded, each as soon as it is compressed,
+    // so only one compressed part is held at a time
+    uint32_t adler = 1;
+    auto emit = [&](EncodedPart& part) {
+        write(part.idat.data(), part.idat.size());
+        written += part.idat.size();
+        adler = adler32Combine(adler, part.adler, part.filteredSize);
+        std::vector<uint8_t>().swap(part.idat);
+    };
+    if (options.threads == 1 || partCount == 1) {
+        for (size_t i = 0; i < partCount; ++i) {
+            encodeIndex(i);
+            emit(parts[i]);
+        }
+    } else {
+        ThreadPool::shared(options.threads).parallelFor(partCount, encodeIndex);
+        for (auto& part : parts) {
+            emit(part);
+        }
+    }
+
+    // Final empty stored block closes the deflate stream, then the zlib checksum
+    std::vector<uint8_t> trailer = {0x01, 0x00, 0x00, 0xFF, 0xFF};
+    appendBigEndian(trailer, adler);
+    png.clear();
+    writeChunk(png, "IDAT", trailer.data(), trailer.size());
+    writeChunk(png, "IEND", nullptr, 0);
+    write(png.data(), png.size());
+    scope.setBytes(rowBytes * image.height + written + png.size());
+}
+
+PngFilter PngEncoder::parseFilter(const std::string& name) {
+    std::string lowerName = name;
+    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+    static const std::pair<const char*, PngFilter> filters[] = {
+        {"none", PngFilter::None}, {"sub", PngFilter::Sub}, {"up", PngFilter::Up},
+        {"average", PngFilter::Average}, {"paeth", PngFilter::Paeth}, {"adaptive", PngFilter::Adaptive}};
+    for (const auto& filter : filters) {
+        if (lowerName == filter.first) {
+            return filter.second;
+        }
+    }
+    throw std::invalid_argument("Unknown PNG filter: " + name +
+                                ". Supported filters: none, sub, up, average, paeth, adaptive");
+}
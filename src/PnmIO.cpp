@@ -0,0 +1,167 @@
+#include "PnmIO.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+
+// Reads one whitespace-delimited decimal header field, skipping '#' comments
+int readHeaderNumber(const uint8_t* bytes, size_t size, size_t& position) {
+    while (position < size) {
+        if (bytes[position] == '#') {
+            while (position < size && bytes[position] != '\n') {
+                ++position;
+            }
+        } else if (std::isspace(bytes[position])) {
+            ++position;
+        } else {
+            break;
+        }
+    }
+
+    long long value = 0;
+    size_t digits = 0;
+    while (position < size && std::isdigit(bytes[position]) && digits < 10) {
+        value = value * 10 + (bytes[position] - '0');
+        ++position;
+        ++digits;
+    }
+    if (digits == 0 || value > std::numeric_limits<int>::max()) {
+        throw std::runtime_error("Malformed PGM/PPM header");
+    }
+    return static_cast<int>(value);
+}
+
+} // namespace
+
+PnmHeader PnmIO::parseHeader(const uint8_t* bytes, size_t size) {
+    if (size < 2 || bytes[0] != 'P' || (bytes[1] != '5' && bytes[1] != '6')) {
+        throw std::runtime_error("Not a binary PGM (P5) or PPM (P6) file");
+    }
+
+    PnmHeader header;
+    header.channels = bytes[1] == '5' ? 1 : 3;
+
+    size_t position = 2;
+    header.width = readHeaderNumber(bytes, size, position);
+    header.height = readHeaderNumber(bytes, size, position);
+    int maxValue = readHeaderNumber(bytes, size, position);
+
+    if (header.width <= 0 || header.height <= 0) {
+        throw std::runtime_error("Invalid PGM/PPM dimensions: " + std::to_string(header.width) + "x" +
+                                std::to_string(header.height));
+    }
+    if (maxValue != 255) {
+        throw std::runtime_error("Unsupported PGM/PPM maxval " + std::to_string(maxValue) +
+                                " (only 8-bit samples are supported)");
+    }
+
+    // Exactly one whitespace character separates the header from the pixels
+    if (position >= size || !std::isspace(bytes[position])) {
+        throw std::runtime_error("Malformed PGM/PPM header");
+    }
+    header.dataOffset = position + 1;
+    return header;
+}
+
+std::string PnmIO::formatHeader(int width, int height, int channels) {
+    if (channels != 1 && channels != 3) {
+        throw std::invalid_argument("PGM/PPM output supports 1 or 3 channels, got " + std::to_string(channels));
+    }
+    return std::string(channels == 1 ? "P5" : "P6") + "\n" + std::to_string(width) + " " +
+           std::to_string(height) + "\n255\n";
+}
+
+bool PnmIO::hasPnmExtension(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".pgm" || extension == ".ppm" || extension == ".pnm";
+}
+
+ScanlineReader::ScanlineReader(const std::string& filepath, int width, int height, int channels,
+                               size_t dataOffset)
+    : stream(filepath, std::ios::binary), filepath(filepath),
+      width(width), height(height), channels(channels) {
+    stream.seekg(static_cast<std::streamoff>(dataOffset));
+}
+
+ScanlineReader ScanlineReader::openPnm(const std::string& filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open file: " + filepath);
+    }
+
+    // Headers are short; 4KB covers any reasonable amount of comments
+    std::vector<uint8_t> prefix(4096);
+    file.read(reinterpret_cast<char*>(prefix.data()), static_cast<std::streamsize>(prefix.size()));
+    PnmHeader header = PnmIO::parseHeader(prefix.data(), static_cast<size_t>(file.gcount()));
+
+    return ScanlineReader(filepath, header.width, header.height, header.channels, header.dataOffset);
+}
+
+ScanlineReader ScanlineReader::openRaw(const std::string& filepath, int width, int height, int channels) {
+    if (width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        throw std::invalid_argument("Invalid raw image geometry");
+    }
+
+    std::error_code ec;
+    auto fileSize = std::filesystem::file_size(filepath, ec);
+    if (ec) {
+        throw std::runtime_error("Cannot open file: " + filepath + " (" + ec.message() + ")");
+    }
+    size_t expectedSize = static_cast<size_t>(width) * height * channels;
+    if (fileSize != expectedSize) {
+        throw std::runtime_error("Raw file size mismatch. Expected: " + std::to_string(expectedSize) +
+                                ", Actual: " + std::to_string(fileSize));
+    }
+
+    return ScanlineReader(filepath, width, height, channels, 0);
+}
+
+void ScanlineReader::readRows(uint8_t* destination, int rowCount) {
+    if (rowCount <= 0) {
+        return;
+    }
+
+    std::streamsize bytes = static_cast<std::streamsize>(rowCount) * width * channels;
+    if (rowsRead + rowCount > height ||
+        !stream.read(reinterpret_cast<char*>(destination), bytes)) {
+        throw std::runtime_error("Unexpected end of image data in: " + filepath);
+    }
+    rowsRead += rowCount;
+}
+
+ScanlineWriter::ScanlineWriter(const std::string& filepath, int width, int height, int channels)
+    : stream(filepath, std::ios::binary | std::ios::trunc), filepath(filepath),
+      width(width), height(height), channels(channels) {
+    if (!stream) {
+        throw std::runtime_error("Cannot create file: " + filepath);
+    }
+    if (PnmIO::hasPnmExtension(filepath)) {
+        stream << PnmIO::formatHeader(width, height, channels);
+    }
+}
+
+void ScanlineWriter::writeRows(const uint8_t* rows, int rowCount) {
+    if (rowsWritten + rowCount > height) {
+        throw std::runtime_error("Too many rows written to: " + filepath);
+    }
+
+    std::streamsize bytes = static_cast<std::streamsize>(rowCount) * width * channels;
+    if (!stream.write(reinterpret_cast<const char*>(rows), bytes)) {
+        throw std::runtime_error("Failed to write: " + filepath + " (possible: disk full)");
+    }
+    rowsWritten += rowCount;
+}
+
+void ScanlineWriter::finish() {
+    if (rowsWritten != height) {
+        throw std::runtime_error("Incomplete image written to: " + filepath + " (" +
+                                std::to_string(rowsWritten) + " of " + std::to_string(height) + " rows)");
+    }
+    if (!stream.flush()) {
+        throw std::runtime_error("Failed to write: " + filepath + " (possible: disk full)");
+    }
+}
@@ -0,0 +1,205 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <sys/resource.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+std::atomic<bool> Profiler::enabled{false};
+thread_local unsigned Profiler::workerDepth = 0;
+
+namespace {
+
+struct Recorder {
+    std::mutex mutex;
+    std::vector<ProfileEvent> events;
+    std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Recorder& recorder() {
+    static Recorder instance;
+    return instance;
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - recorder().epoch).count();
+}
+
+uint32_t threadId() {
+    static std::atomic<uint32_t> nextId{1};
+    thread_local uint32_t id = nextId.fetch_add(1);
+    return id;
+}
+
+// Bytes currently allocated through malloc (0 where the C library cannot tell)
+int64_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<int64_t>(info.uordblks + info.hblkhd);
+#else
+    return 0;
+#endif
+}
+
+// High-water mark of the resident set size of the whole process
+int64_t peakResident() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<int64_t>(usage.ru_maxrss) * 1024;  // Kilobytes on Linux
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+void Profiler::Scope::begin(size_t bytes, const std::string& detail) {
+    event.name = name;
+    event.detail = detail;
+    event.thread = threadId();
+    event.bytes = bytes;
+    event.memorySampled = workerDepth == 0;
+    if (event.memorySampled) {
+        startHeap = heapInUse();
+        startPeak = peakResident();
+    }
+    event.startNs = nowNs();
+}
+
+void Profiler::Scope::end() {
+    event.durationNs = nowNs() - event.startNs;
+    if (event.memorySampled) {
+        event.heapDeltaBytes = heapInUse() - startHeap;
+        event.peakGrowthBytes = peakResident() - startPeak;
+    }
+
+    Recorder& state = recorder();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.events.push_back(std::move(event));
+}
+
+void Profiler::enable(bool on) {
+    Recorder& state = recorder();
+    if (on) {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.events.clear();
+        state.epoch = std::chrono::steady_clock::now();
+    }
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+std::vector<ProfileEvent> Profiler::events() {
+    Recorder& state = recorder();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.events;
+}
+
+std::string Profiler::summary() {
+    struct StageTotals {
+        size_t calls = 0;
+        int64_t durationNs = 0;
+        size_t bytes = 0;
+        int64_t heapDeltaBytes = 0;
+        int64_t peakGrowthBytes = 0;
+        bool memorySampled = false;
+    };
+
+    std::vector<ProfileEvent> recorded = events();
+    std::vector<std::string> order;                 // Stages in order of first completion
+    std::map<std::string, StageTotals> totals;
+    int64_t first = INT64_MAX, last = 0;
+    for (const auto& event : recorded) {
+        if (!totals.count(event.name)) {
+            order.push_back(event.name);
+        }
+        StageTotals& stage = totals[event.name];
+        stage.calls++;
+        stage.durationNs += event.durationNs;
+        stage.bytes += event.bytes;
+        stage.heapDeltaBytes += event.heapDeltaBytes;
+        stage.peakGrowthBytes += event.peakGrowthBytes;
+        stage.memorySampled |= event.memorySampled;
+        first = std::min(first, event.startNs);
+        last = std::max(last, event.startNs + event.durationNs);
+    }
+
+    // Stages nest (a band runs inside detect) and overlap across threads, so shares
+    // are relative to the profiled wall time and need not add up to 100%
+    double wallNs = recorded.empty() ? 0.0 : static_cast<double>(last - first);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "Profile (" << wallNs / 1e6 << " ms wall)\n";
+    out << std::left << std::setw(14) << "Stage" << std::right << std::setw(7) << "Calls"
+        << std::setw(12) << "Total ms" << std::setw(11) << "Mean ms" << std::setw(8) << "Wall%"
+        << std::setw(11) << "MB" << std::setw(9) << "GB/s" << std::setw(11) << "Heap +MB"
+        << std::setw(11) << "Peak +MB" << "\n";
+    for (const auto& name : order) {
+        const StageTotals& stage = totals[name];
+        double totalMs = stage.durationNs / 1e6;
+        out << std::left << std::setw(14) << name << std::right << std::setw(7) << stage.calls
+            << std::setw(12) << totalMs << std::setw(11) << totalMs / stage.calls
+            << std::setw(8) << (wallNs > 0 ? 100.0 * stage.durationNs / wallNs : 0.0)
+            << std::setw(11) << stage.bytes / 1e6
+            << std::setw(9) << (stage.durationNs > 0 ? static_cast<double>(stage.bytes) / stage.durationNs : 0.0)
+            << std::setw(11);
+        // Worker stages carry no memory figures
+        if (stage.memorySampled) {
+            out << stage.heapDeltaBytes / 1e6 << std::setw(11) << stage.peakGrowthBytes / 1e6 << "\n";
+        } else {
+            out << "-" << std::setw(11) << "-" << "\n";
+        }
+    }
+    return out.str();
+}
+
+void Profiler::writeChromeTrace(const std::string& path) {
+    std::ofstream file(path, std::ios::trunc);
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+    // Complete ("X") events with microsecond timestamps
+    std::vector<ProfileEvent> recorded = events();
+    for (size_t i = 0; i < recorded.size(); ++i) {
+        const ProfileEvent& event = recorded[i];
+        file << (i ? ",\n" : "\n") << "{\"name\": \"" << jsonEscape(event.name)
+             << "\", \"cat\": \"edge_detector\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+             << ", \"ts\": " << event.startNs / 1e3 << ", \"dur\": " << event.durationNs / 1e3
+             << ", \"args\": {\"bytes\": " << event.bytes;
+        if (event.memorySampled) {
+            file << ", \"heap_delta_bytes\": " << event.heapDeltaBytes
+                 << ", \"peak_growth_bytes\": " << event.peakGrowthBytes;
+        }
+        if (!event.detail.empty()) {
+            file << ", \"detail\": \"" << jsonEscape(event.detail) << "\"";
+        }
+        file << "}}";
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+}
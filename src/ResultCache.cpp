@@ -0,0 +1,247 @@
+#include "ResultCache.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+// Bumped whenever results for the same input and settings change, e.g. a new luma formula,
+// so entries written by older builds stop matching
+constexpr uint64_t KEY_VERSION = 1;
+
+// Eviction frees down to this fraction of the limit, so a full cache is not rescanned on
+// every store
+constexpr double EVICTION_TARGET = 0.9;
+
+// Temporary files of store() older than this were left by a crashed writer; younger ones
+// may belong to a store in flight in another process
+constexpr std::chrono::hours STALE_TEMPORARY_AGE{1};
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t read64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t mixLane(uint64_t accumulator, uint64_t input) {
+    return rotateLeft(accumulator + input * PRIME2, 31) * PRIME1;
+}
+
+inline uint64_t mergeRound(uint64_t accumulator, uint64_t value) {
+    return (accumulator ^ mixLane(0, value)) * PRIME1 + PRIME4;
+}
+
+std::string toHex(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int i = 15; i >= 0; --i, value >>= 4) {
+        text[i] = digits[value & 15];
+    }
+    return text;
+}
+
+} // namespace
+
+ResultCache::ResultCache(const std::string& directory, uint64_t maxBytes) : root(directory), maxBytes(maxBytes) {}
+
+// XXH64: four independent lanes consume 32 bytes per step, so the hash runs at memory speed
+uint64_t ResultCache::hash(ByteSpan data, uint64_t seed) {
+    const uint8_t* p = data.data();
+    const uint8_t* end = p + data.size();
+    uint64_t h;
+
+    if (data.size() >= 32) {
+        uint64_t v1 = seed + PRIME1 + PRIME2, v2 = seed + PRIME2, v3 = seed, v4 = seed - PRIME1;
+        for (; p + 32 <= end; p += 32) {
+            v1 = mixLane(v1, read64(p));
+            v2 = mixLane(v2, read64(p + 8));
+            v3 = mixLane(v3, read64(p + 16));
+            v4 = mixLane(v4, read64(p + 24));
+        }
+        h = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        h = mergeRound(mergeRound(mergeRound(mergeRound(h, v1), v2), v3), v4);
+    } else {
+        h = seed + PRIME5;
+    }
+    h += data.size();
+
+    for (; p + 8 <= end; p += 8) {
+        h = rotateLeft(h ^ mixLane(0, read64(p)), 27) * PRIME1 + PRIME4;
+    }
+    if (p + 4 <= end) {
+        h = rotateLeft(h ^ (read32(p) * PRIME1), 23) * PRIME2 + PRIME3;
+        p += 4;
+    }
+    for (; p < end; ++p) {
+        h = rotateLeft(h ^ (*p * PRIME5), 11) * PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME2;
+    h ^= h >> 29;
+    h *= PRIME3;
+    return h ^ (h >> 32);
+}
+
+uint64_t ResultCache::fileHash(const std::string& path) {
+    // Empty files cannot be mapped; they hash like any other empty input
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) == 0 && !ec) {
+        return hash(ByteSpan(nullptr, 0));
+    }
+    auto file = MappedFile::openRead(path);
+    return hash(ByteSpan(file->data(), file->size()));
+}
+
+uint64_t ResultCache::pixelHash(const ImageView& image) {
+    const int32_t geometry[3] = {image.width, image.height, image.channels};
+    uint64_t h = hash(ByteSpan(reinterpret_cast<const uint8_t*>(geometry), sizeof(geometry)));
+    size_t rowBytes = static_cast<size_t>(image.width) * image.channels;
+    for (int y = 0; y < image.height; ++y) {
+        h = hash(ByteSpan(image.row(y), rowBytes), h);
+    }
+    return h;
+}
+
+std::string ResultCache::key(uint64_t contentHash, const std::string& settings) {
+    return toHex(hash(ByteSpan(reinterpret_cast<const uint8_t*>(settings.data()), settings.size()),
+                      contentHash ^ KEY_VERSION));
+}
+
+std::string ResultCache::describe(const std::string& operatorName, const EdgeDetectionOptions& detection,
+                                  const LoadOptions& load, const PngOptions& png, const std::string& extension) {
+    std::string op = operatorName, format = extension;
+    std::transform(op.begin(), op.end(), op.begin(), ::tolower);
+    std::transform(format.begin(), format.end(), format.begin(), ::tolower);
+
+    std::string settings = "operator=" + op + " norm=" + std::to_string(static_cast<int>(detection.norm)) +
+                           " luma=" + std::to_string(static_cast<int>(detection.luma)) + " format=" + format;
+    if (load.grayscale) {
+        settings += " load-luma=" + std::to_string(static_cast<int>(load.luma));
+    }
+    if (format == ".png") {
+        settings += " png=" + std::to_string(png.compressionLevel) + "/" +
+                    std::to_string(static_cast<int>(png.filter));
+    }
+    return settings;
+}
+
+bool ResultCache::fetch(const std::string& key, const std::string& outputPath) {
+    std::filesystem::path entry = std::filesystem::path(root) / key;
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(entry, ec) &&
+        std::filesystem::copy_file(entry, outputPath, std::filesystem::copy_options::overwrite_existing, ec)) {
+        // The modification time doubles as the last-use time for eviction
+        std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+        ++hits;
+        return true;
+    }
+    ++misses;
+    return false;
+}
+
+void ResultCache::store(const std::string& key, const std::string& outputPath) {
+    static std::atomic<unsigned> nextTemporary{0};
+    std::filesystem::path entry = std::filesystem::path(root) / key;
+    std::filesystem::path temporary = std::filesystem::path(root) /
+        (key + ".tmp" + std::to_string(getpid()) + "_" + std::to_string(nextTemporary++));
+
+    // Copy to a private file and rename it over the entry, so no reader sees a partial file
+    std::error_code ec;
+    std::filesystem::create_directories(root, ec);
+    if (!std::filesystem::copy_file(outputPath, temporary, std::filesystem::copy_options::overwrite_existing, ec)) {
+        std::filesystem::remove(temporary, ec);
+        return;
+    }
+    uint64_t size = std::filesystem::file_size(temporary, ec);
+    if (ec) {
+        size = 0;
+    }
+    std::filesystem::last_write_time(temporary, std::filesystem::file_time_type::clock::now(), ec);
+    std::filesystem::rename(temporary, entry, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        return;
+    }
+    ++stores;
+
+    // The size estimate only grows between scans; other processes sharing the directory
+    // are accounted for when the estimate crosses the limit and the directory is rescanned
+    std::lock_guard<std::mutex> lock(mutex);
+    knownBytes += size;
+    if (!scanned || knownBytes > maxBytes) {
+        evict();
+    }
+}
+
+void ResultCache::evict() {
+    struct Entry {
+        std::filesystem::path path;
+        std::filesystem::file_time_type lastUse;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    std::error_code ec;
+    for (std::filesystem::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+        std::error_code entryError;
+        if (!it->is_regular_file(entryError)) {
+            continue;
+        }
+        Entry entry{it->path(), it->last_write_time(entryError), it->file_size(entryError)};
+        if (!entryError && entry.path.filename().string().find(".tmp") != std::string::npos) {
+            // Not an entry: never counted, and only removed once clearly abandoned
+            if (std::filesystem::file_time_type::clock::now() - entry.lastUse > STALE_TEMPORARY_AGE) {
+                std::filesystem::remove(entry.path, entryError);
+            }
+            continue;
+        }
+        if (!entryError) {
+            entries.push_back(entry);
+            total += entry.size;
+        }
+    }
+
+    if (total > maxBytes) {
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+        uint64_t target = static_cast<uint64_t>(maxBytes * EVICTION_TARGET);
+        for (const Entry& entry : entries) {
+            if (total <= target) {
+                break;
+            }
+            if (std::filesystem::remove(entry.path, ec)) {
+                total -= entry.size;
+                ++evictions;
+            }
+        }
+    }
+    knownBytes = total;
+    scanned = true;
+}
+
+CacheStats ResultCache::stats() const {
+    return CacheStats{hits.load(), misses.load(), stores.load(), evictions.load()};
+}
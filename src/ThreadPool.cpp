@@ -0,0 +1,127 @@
+#include "ThreadPool.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The caller runs tasks too, so only threadCount - 1 workers are needed
+    try {
+        for (unsigned i = 1; i < threadCount; ++i) {
+            workers.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    } catch (...) {
+        // Joinable threads must not be destroyed, so stop the ones already running
+        stopWorkers();
+        throw;
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    stopWorkers();
+}
+
+void ThreadPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& job) {
+    if (count == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &job;
+        taskCount = count;
+        nextIndex.store(0, std::memory_order_relaxed);
+        busyWorkers = workers.size();
+        error = nullptr;
+        ++generation;
+    }
+    wake.notify_all();
+
+    runTasks();
+
+    std::exception_ptr failure;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return busyWorkers == 0; });
+        task = nullptr;
+        failure = error;
+    }
+
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+// Claims indices until the current job is exhausted; the first exception is kept
+void ThreadPool::runTasks() {
+    // Tasks run alongside each other, so their profiled stages skip process-wide memory figures
+    Profiler::WorkerSection section;
+    size_t index;
+    while ((index = nextIndex.fetch_add(1, std::memory_order_relaxed)) < taskCount) {
+        try {
+            (*task)(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned long long seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runTasks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            finished.notify_one();
+        }
+    }
+}
+
+ThreadPool& ThreadPool::shared(unsigned threadCount) {
+    // More threads than cores cannot speed anything up, so 0 and every larger count share
+    // the hardware_concurrency pool and the number of pools stays bounded by the core count
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    if (threadCount == 0 || threadCount > cores) {
+        threadCount = cores;
+    }
+
+    // One persistent pool per distinct size, kept alive for the whole process
+    static std::mutex poolsMutex;
+    static std::map<unsigned, std::unique_ptr<ThreadPool>> pools;
+
+    std::lock_guard<std::mutex> lock(poolsMutex);
+    auto& pool = pools[threadCount];
+    if (!pool) {
+        pool = std::make_unique<ThreadPool>(threadCount);
+    }
+    return *pool;
+}
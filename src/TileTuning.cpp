@@ -0,0 +1,181 @@
+#include "TileTuning.h"
+#include "GradientKernels.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+
+// Calibration input: wide enough that full rows stress L1, short enough to run in
+// well under a second for all candidates
+constexpr int CALIBRATION_WIDTH = 8192;
+constexpr int CALIBRATION_HEIGHT = 192;
+constexpr int CALIBRATION_RUNS = 3;
+
+// A tiling has to beat full-width bands by this factor to be chosen, so timing
+// noise does not switch machines to a tiling that does not pay off
+constexpr double REQUIRED_SPEEDUP = 1.05;
+
+const int CANDIDATE_WIDTHS[] = {256, 512, 1024, 2048, 4096};
+const int CANDIDATE_HEIGHTS[] = {8, 32, 128};
+
+// Fastest of several runs, in nanoseconds
+double timeDetection(const ImageView& image, const TileSize& tiles, std::vector<uint8_t>& output,
+                     EdgeDetector::Workspace& workspace) {
+    EdgeDetectionOptions options;
+    options.tiles = tiles;
+    double best = 0;
+    for (int run = 0; run < CALIBRATION_RUNS; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        EdgeDetector::detectEdgesInto(image, EdgeOperator::Sobel, output.data(), image.width, workspace, options);
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+} // namespace
+
+TileSize TileTuning::calibrate() {
+    // Deterministic noise, so no region is trivially predictable
+    std::vector<uint8_t> pixels(static_cast<size_t>(CALIBRATION_WIDTH) * CALIBRATION_HEIGHT * 3);
+    uint32_t seed = 12345;
+    for (auto& value : pixels) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<uint8_t>(seed >> 24);
+    }
+    ImageView image{pixels.data(), CALIBRATION_WIDTH, CALIBRATION_HEIGHT, 3,
+                    static_cast<size_t>(CALIBRATION_WIDTH) * 3};
+    std::vector<uint8_t> output(static_cast<size_t>(CALIBRATION_WIDTH) * CALIBRATION_HEIGHT);
+    EdgeDetector::Workspace workspace;
+
+    // The first run also warms up the caches, the workspace and the output pages
+    double untiled = timeDetection(image, TileSize{}, output, workspace);
+    TileSize best;
+    double bestTime = untiled / REQUIRED_SPEEDUP;
+    for (int width : CANDIDATE_WIDTHS) {
+        for (int height : CANDIDATE_HEIGHTS) {
+            double elapsed = timeDetection(image, TileSize{width, height}, output, workspace);
+            if (elapsed < bestTime) {
+                bestTime = elapsed;
+                best = TileSize{width, height};
+            }
+        }
+    }
+    return best;
+}
+
+std::optional<TileSize> TileTuning::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::nullopt;
+    }
+
+    std::string line, variant;
+    std::optional<TileSize> tiles;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string key, value;
+        if (!(fields >> key >> value) || key[0] == '#') {
+            continue;
+        }
+        if (key == "variant") {
+            variant = value;
+        } else if (key == "tile") {
+            try {
+                tiles = parse(value);
+            } catch (const std::invalid_argument&) {
+                return std::nullopt;
+            }
+        }
+    }
+    if (variant != GradientKernels::active().name) {
+        return std::nullopt;
+    }
+    return tiles;
+}
+
+void TileTuning::save(const std::string& path, const TileSize& tiles) {
+    std::filesystem::path target(path);
+    std::error_code ec;
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), ec);
+    }
+
+    // Write a private file and rename it over the target, so processes tuning at the
+    // same time never read a partial file
+    std::string temporary = path + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << "# edge_detector tile tuning\n"
+             << "variant " << GradientKernels::active().name << "\n"
+             << "tile " << format(tiles) << "\n";
+        if (!file.flush()) {
+            std::filesystem::remove(temporary, ec);
+            throw std::runtime_error("Failed to write tuning file: " + path);
+        }
+    }
+    std::filesystem::rename(temporary, target, ec);
+    if (ec) {
+        std::filesystem::remove(temporary, ec);
+        throw std::runtime_error("Failed to write tuning file: " + path);
+    }
+}
+
+TileSize TileTuning::tuned(const std::string& path) {
+    static std::mutex mutex;
+    static std::map<std::string, TileSize> cache;
+
+    std::string file = path.empty() ? defaultPath() : path;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto cached = cache.find(file);
+    if (cached != cache.end()) {
+        return cached->second;
+    }
+
+    std::optional<TileSize> tiles = load(file);
+    if (!tiles) {
+        tiles = calibrate();
+        try {
+            save(file, *tiles);
+        } catch (const std::runtime_error&) {
+            // An unwritable cache only costs the calibration again next time
+        }
+    }
+    cache[file] = *tiles;
+    return *tiles;
+}
+
+std::string TileTuning::defaultPath() {
+    const char* cacheHome = std::getenv("XDG_CACHE_HOME");
+    if (cacheHome && *cacheHome) {
+        return std::string(cacheHome) + "/edge_detector/tiles.conf";
+    }
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        return std::string(home) + "/.cache/edge_detector/tiles.conf";
+    }
+    return "edge_detector_tiles.conf";
+}
+
+TileSize TileTuning::parse(const std::string& text) {
+    TileSize tiles;
+    char separator = 0;
+    std::istringstream fields(text);
+    if (!(fields >> tiles.width >> separator >> tiles.height) || separator != 'x' || fields.peek() != EOF ||
+        tiles.width < 0 || tiles.height < 0) {
+        throw std::invalid_argument("Invalid tile size: " + text + " (expected WxH, e.g. 1024x32)");
+    }
+    return tiles;
+}
+
+std::string TileTuning::format(const TileSize& tiles) {
+    return std::to_string(tiles.width) + "x" + std::to_string(tiles.height);
+}
@@ -1,55 +1,544 @@
-#include <iostream>       
+#include <algorithm>
+#include <cctype>
+#include <iostream>
 #include <exception>
-#include <filesystem>      
-#include "Image.h"        
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Image.h"
 #include "EdgeDetector.h"
+#include "BatchProcessor.h"
+#include "PnmIO.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+#include "EdgeServer.h"
+#include "TileTuning.h"
+#include "ResultCache.h"
+#include <csignal>
+#include <thread>
 
-int main(int argc, char* argv[]) {
-    // Check command line arguments
-    if (argc != 3) {
-        std::cout << "Usage: " << argv[0] << " <image_path> <operator>" << std::endl;
-        std::cout << "Operators: Sobel, Prewitt (case-insensitive)" << std::endl;
-        std::cout << "Example: " << argv[0] << " sample_images/cameraman.jpg Sobel" << std::endl;
+// Command line split into positional arguments, --option value pairs and --flags
+struct CommandLine {
+    std::vector<std::string> positional;
+    std::map<std::string, std::string> options;
+    std::set<std::string> flags;
+
+    bool has(const std::string& name) const { return options.count(name) || flags.count(name); }
+    std::string get(const std::string& name, const std::string& fallback) const {
+        auto it = options.find(name);
+        return it == options.end() ? fallback : it->second;
+    }
+};
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " <image_path> <operator> [options]" << std::endl;
+    std::cout << "       " << program << " --batch <directory|list_file> <operator> [options]" << std::endl;
+    std::cout << "       " << program << " --stream <image.pgm|image.ppm|image.raw> <operator> [options]" << std::endl;
+    std::cout << "       " << program << " --serve <socket_path> [--workers <n>] [--tile <WxH|auto>]" << std::endl;
+    std::cout << "Operators: Sobel, Prewitt, Scharr, Canny (case-insensitive; Canny in single-image mode)" << std::endl;
+    std::cout << "           In single-image mode a comma-separated list (e.g. Sobel,Prewitt) computes" << std::endl;
+    std::cout << "           every operator in one pass over the image" << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --norm <norm>        L2 (default, Euclidean), L1 (|gx|+|gy|), Linf (max(|gx|,|gy|))" << std::endl;
+    std::cout << "  --threads <n>        Threads per image (default 1, 0 = all cores)" << std::endl;
+    std::cout << "  --luma <std>         Decode color inputs straight to luma: BT601 (JPEG's own luma" << std::endl;
+    std::cout << "                       plane) or BT709; without it color is converted with BT601 on the fly" << std::endl;
+    std::cout << "  --tile <WxH|auto>    Process in cache-sized tiles (0 = whole width/height); auto" << std::endl;
+    std::cout << "                       reads the tuning file, calibrating once if it is missing" << std::endl;
+    std::cout << "  --tuning-file <path> Tile tuning file (default: ~/.cache/edge_detector/tiles.conf)" << std::endl;
+    std::cout << "  --output-dir <dir>   Output folder (default: output)" << std::endl;
+    std::cout << "  --raw-size <WxHxC>   Geometry of a headerless raw input" << std::endl;
+    std::cout << "  --output-format <f>  png (default), pgm or raw; pgm/raw are written uncompressed via mmap" << std::endl;
+    std::cout << "  --png-level <0-9>    PNG compression: 0 = store (fastest), 1 = fast ... 9 = smallest (default 6)" << std::endl;
+    std::cout << "  --png-filter <f>     PNG row filter: adaptive (default), none, sub, up, average, paeth" << std::endl;
+    std::cout << "  --canny-low <t>      Canny: weak edge threshold on the Sobel magnitude (default 40)" << std::endl;
+    std::cout << "  --canny-high <t>     Canny: strong edge threshold on the Sobel magnitude (default 100)" << std::endl;
+    std::cout << "  --cache-dir <dir>    Reuse results of identical inputs and settings stored in <dir>;" << std::endl;
+    std::cout << "                       hits skip decoding, detection and encoding (single/batch mode)" << std::endl;
+    std::cout << "  --cache-size <MB>    Cache size limit; least recently used results are evicted (default 1024)" << std::endl;
+    std::cout << "  --workers <n>        Serve mode: concurrent connections (default 0 = all cores)" << std::endl;
+    std::cout << "  --profile            Print a per-stage time/memory breakdown and write" << std::endl;
+    std::cout << "                       <output-dir>/profile_trace.json (chrome://tracing)" << std::endl;
+    std::cout << "Example: " << program << " sample_images/cameraman.jpg Sobel" << std::endl;
+}
+
+// Returns false on unknown options or missing option values
+bool parseCommandLine(int argc, char* argv[], CommandLine& commandLine) {
+    static const std::set<std::string> valueOptions = {"--norm", "--threads", "--output-dir", "--raw-size",
+                                                       "--output-format", "--png-level", "--png-filter",
+                                                       "--canny-low", "--canny-high", "--workers", "--luma",
+                                                       "--tile", "--tuning-file", "--cache-dir", "--cache-size"};
+    static const std::set<std::string> flagOptions = {"--batch", "--stream", "--profile", "--serve"};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        if (argument.rfind("--", 0) != 0) {
+            commandLine.positional.push_back(argument);
+        } else if (flagOptions.count(argument)) {
+            commandLine.flags.insert(argument);
+        } else if (valueOptions.count(argument) && i + 1 < argc) {
+            commandLine.options[argument] = argv[++i];
+        } else {
+            std::cout << "Unknown or incomplete option: " << argument << std::endl;
+            return false;
+        }
+    }
+    // Serve mode takes only the socket path; requests name their own operator
+    return commandLine.positional.size() == (commandLine.has("--serve") ? 1u : 2u);
+}
+
+EdgeDetectionOptions detectionOptions(const CommandLine& commandLine) {
+    EdgeDetectionOptions options;
+    options.norm = EdgeDetector::parseNorm(commandLine.get("--norm", "L2"));
+    options.luma = Image::parseLuma(commandLine.get("--luma", "BT601"));
+    std::string tiles = commandLine.get("--tile", "0x0");
+    options.tiles = tiles == "auto" ? TileTuning::tuned(commandLine.get("--tuning-file", ""))
+                                    : TileTuning::parse(tiles);
+    std::string threads = commandLine.get("--threads", "1");
+    try {
+        options.threads = static_cast<unsigned>(std::stoul(threads));
+    } catch (const std::exception&) {
+        throw std::invalid_argument("Invalid thread count: " + threads);
+    }
+    return options;
+}
+
+// --luma converts color inputs to single-channel images while loading; raw inputs
+// stay in color and are converted on the fly with the same weights
+LoadOptions loadOptions(const CommandLine& commandLine) {
+    LoadOptions options;
+    options.grayscale = commandLine.has("--luma");
+    options.luma = Image::parseLuma(commandLine.get("--luma", "BT601"));
+    return options;
+}
+
+// PNG encoder settings; encoding uses as many threads as detection
+PngOptions pngOptions(const CommandLine& commandLine, const EdgeDetectionOptions& detection) {
+    PngOptions options;
+    options.filter = PngEncoder::parseFilter(commandLine.get("--png-filter", "adaptive"));
+    options.threads = detection.threads;
+    std::string level = commandLine.get("--png-level", "6");
+    if (level.size() != 1 || !std::isdigit(static_cast<unsigned char>(level[0]))) {
+        throw std::invalid_argument("Invalid PNG compression level: " + level + " (expected 0-9)");
+    }
+    options.compressionLevel = level[0] - '0';
+    return options;
+}
+
+bool isCanny(const std::string& operatorName) {
+    std::string lowerName = operatorName;
+    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+    return lowerName == "canny";
+}
+
+// Splits a comma-separated operator list; a single name yields one entry
+std::vector<std::string> splitOperators(const std::string& operatorList) {
+    std::vector<std::string> names;
+    std::istringstream list(operatorList);
+    for (std::string name; std::getline(list, name, ',');) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+CannyOptions cannyOptions(const CommandLine& commandLine, const EdgeDetectionOptions& detection) {
+    CannyOptions options;
+    options.threads = detection.threads;
+    options.luma = detection.luma;
+    for (auto [name, threshold] : {std::make_pair("--canny-low", &options.lowThreshold),
+                                   std::make_pair("--canny-high", &options.highThreshold)}) {
+        std::string value = commandLine.get(name, std::to_string(*threshold));
+        try {
+            *threshold = std::stoi(value);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Invalid Canny threshold: " + value);
+        }
+    }
+    return options;
+}
+
+// Result cache from --cache-dir and --cache-size (MB); null when caching is off
+std::unique_ptr<ResultCache> resultCache(const CommandLine& commandLine) {
+    if (!commandLine.has("--cache-dir")) {
+        return nullptr;
+    }
+    std::string size = commandLine.get("--cache-size", std::to_string(ResultCache::DEFAULT_MAX_BYTES >> 20));
+    uint64_t megabytes = 0;
+    try {
+        megabytes = std::stoull(size);
+    } catch (const std::exception&) {
+        throw std::invalid_argument("Invalid cache size: " + size + " (expected megabytes)");
+    }
+    return std::make_unique<ResultCache>(commandLine.get("--cache-dir", ""), megabytes << 20);
+}
+
+void printCacheStats(const ResultCache& cache) {
+    CacheStats stats = cache.stats();
+    std::cout << "Result cache: " << stats.hits << " hits, " << stats.misses << " misses, " << stats.evictions
+              << " evicted (" << cache.directory() << ")" << std::endl;
+}
+
+int runBatch(const CommandLine& commandLine) {
+    std::string source = commandLine.positional[0];
+
+    BatchOptions options;
+    options.operatorName = commandLine.positional[1];
+    options.outputDir = commandLine.get("--output-dir", "output");
+
+    std::cout << "Edge Detection Program (batch mode)" << std::endl;
+    std::cout << "===================================" << std::endl;
+    std::cout << "Input source: " << source << std::endl;
+    std::cout << "Edge detection operator: " << options.operatorName << std::endl;
+
+    try {
+        options.detection = detectionOptions(commandLine);
+        options.png = pngOptions(commandLine, options.detection);
+        options.load = loadOptions(commandLine);
+        std::unique_ptr<ResultCache> cache = resultCache(commandLine);
+        options.cache = cache.get();
+        std::vector<std::string> inputs = BatchProcessor::collectInputs(source);
+        std::cout << "\nProcessing " << inputs.size() << " images..." << std::endl;
+
+        BatchResult result = BatchProcessor::run(inputs, options);
+        for (const auto& error : result.errors) {
+            std::cout << "❌ " << error << std::endl;
+        }
+
+        std::cout << "\nProcessed " << result.succeeded << " of " << inputs.size() << " images in "
+                  << result.seconds << " s (" << result.imagesPerSecond() << " images/sec)" << std::endl;
+        std::cout << "Results saved to: " << options.outputDir << std::endl;
+        if (cache) {
+            printCacheStats(*cache);
+        }
+        return result.errors.empty() ? 0 : 1;
+
+    } catch (const std::exception& e) {
+        std::cout << "\n❌ Error: " << e.what() << std::endl;
         return 1;
     }
-    
-    std::string imagePath = argv[1];
-    std::string operatorName = argv[2];
-    
+}
+
+// Geometry of a headerless raw input given as "WxHxC"
+struct RawSize {
+    int width = 0, height = 0, channels = 0;
+};
+
+RawSize parseRawSize(const std::string& geometry) {
+    RawSize size;
+    char separator1 = 0, separator2 = 0;
+    std::istringstream parser(geometry);
+    if (!(parser >> size.width >> separator1 >> size.height >> separator2 >> size.channels) ||
+        separator1 != 'x' || separator2 != 'x' || !parser.eof()) {
+        throw std::invalid_argument("Invalid raw size: " + geometry + " (expected WxHxC)");
+    }
+    return size;
+}
+
+// Output file extension for --output-format
+std::string outputExtension(const CommandLine& commandLine, const std::string& fallback) {
+    std::string format = commandLine.get("--output-format", fallback);
+    std::transform(format.begin(), format.end(), format.begin(), ::tolower);
+    if (format != "png" && format != "pgm" && format != "raw") {
+        throw std::invalid_argument("Unknown output format: " + format + ". Supported formats: png, pgm, raw");
+    }
+    return "." + format;
+}
+
+Image loadRaw(const std::string& path, const CommandLine& commandLine) {
+    RawSize size = parseRawSize(commandLine.get("--raw-size", ""));
+    return Image::loadRaw(path, size.width, size.height, size.channels);
+}
+
+ScanlineReader openStreamInput(const std::string& path, const CommandLine& commandLine) {
+    if (!commandLine.has("--raw-size")) {
+        return ScanlineReader::openPnm(path);
+    }
+    RawSize size = parseRawSize(commandLine.get("--raw-size", ""));
+    return ScanlineReader::openRaw(path, size.width, size.height, size.channels);
+}
+
+int runStream(const CommandLine& commandLine) {
+    std::string imagePath = commandLine.positional[0];
+    std::string operatorName = commandLine.positional[1];
+
+    std::cout << "Edge Detection Program (streaming mode)" << std::endl;
+    std::cout << "=======================================" << std::endl;
+    std::cout << "Input image: " << imagePath << std::endl;
+    std::cout << "Edge detection operator: " << operatorName << std::endl;
+
+    try {
+        EdgeDetectionOptions options = detectionOptions(commandLine);
+        std::string extension = outputExtension(commandLine, "pgm");
+        if (extension == ".png") {
+            throw std::invalid_argument("Streaming mode writes pgm or raw output");
+        }
+
+        ScanlineReader reader = openStreamInput(imagePath, commandLine);
+        std::cout << "Image opened: " << reader.getWidth() << "x" << reader.getHeight()
+                  << " (" << reader.getChannels() << " channels)" << std::endl;
+
+        std::string outputDir = commandLine.get("--output-dir", "output");
+        std::filesystem::create_directories(outputDir);
+        std::string outputPath = outputDir + "/result_" + operatorName + "_edges" + extension;
+
+        // Rows flow from the reader through the detector to the writer strip by strip
+        std::cout << "\nApplying " << operatorName << " edge detection..." << std::endl;
+        ScanlineWriter writer(outputPath, reader.getWidth(), reader.getHeight(), 1);
+        EdgeDetector::detectEdgesStreaming(reader, writer, operatorName, options);
+
+        std::cout << "\n😊 Edge detection completed successfully!" << std::endl;
+        std::cout << "Result saved to: " << outputPath << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cout << "\n❌ Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+// Computes one operator (or Canny) and writes the result file
+void detectSingle(const CommandLine& commandLine, const Image& img, const std::string& operatorName,
+                  const EdgeDetectionOptions& options, const PngOptions& png, const std::string& extension,
+                  const std::string& outputPath) {
+    // Apply edge detection with user's chosen operator
+    std::cout << "\nApplying " << operatorName << " edge detection..." << std::endl;
+    bool canny = isCanny(operatorName);
+    if (extension == ".png") {
+        Image edgeResult = canny ? EdgeDetector::detectCanny(img.view(), cannyOptions(commandLine, options))
+                                 : EdgeDetector::detectEdges(img, operatorName, options);
+
+        // Save the result
+        std::cout << "\nSaving result..." << std::endl;
+        edgeResult.saveToFile(outputPath, png);
+        return;
+    }
+
+    // Uncompressed results are computed straight into the output file mapping;
+    // check the operator first so a bad name does not leave an empty file behind
+    CannyOptions cannySettings;
+    if (canny) {
+        cannySettings = cannyOptions(commandLine, options);
+    } else {
+        EdgeDetector::validateOperator(operatorName);
+    }
+    std::string header = extension == ".pgm" ? PnmIO::formatHeader(img.getWidth(), img.getHeight(), 1) : "";
+    size_t resultSize = static_cast<size_t>(img.getWidth()) * img.getHeight();
+    auto mapping = MappedFile::create(outputPath, header.size() + resultSize);
+    std::copy(header.begin(), header.end(), mapping->mutableData());
+
+    uint8_t* result = mapping->mutableData() + header.size();
+    if (canny) {
+        EdgeDetector::detectCannyInto(img.view(), result, img.getWidth(), cannySettings);
+    } else {
+        EdgeDetector::Workspace workspace;
+        EdgeDetector::detectEdgesInto(img.view(), operatorName, result, img.getWidth(), workspace, options);
+    }
+    mapping->commit();
+}
+
+// Everything besides the input bytes that a single-image result depends on
+std::string cacheSettings(const CommandLine& commandLine, const std::string& operatorName,
+                          const EdgeDetectionOptions& options, const PngOptions& png, const std::string& extension) {
+    std::string settings = ResultCache::describe(operatorName, options, loadOptions(commandLine), png, extension);
+    if (isCanny(operatorName)) {
+        CannyOptions canny = cannyOptions(commandLine, options);
+        settings += " canny=" + std::to_string(canny.lowThreshold) + "," + std::to_string(canny.highThreshold);
+    }
+    if (commandLine.has("--raw-size")) {
+        settings += " raw=" + commandLine.get("--raw-size", "");
+    }
+    return settings;
+}
+
+int runSingle(const CommandLine& commandLine) {
+    std::string imagePath = commandLine.positional[0];
+    std::string operatorName = commandLine.positional[1];
+    std::string normName = commandLine.get("--norm", "L2");
+
     std::cout << "Edge Detection Program" << std::endl;
     std::cout << "======================" << std::endl;
     std::cout << "Input image: " << imagePath << std::endl;
     std::cout << "Edge detection operator: " << operatorName << std::endl;
-    
+    std::cout << "Gradient norm: " << normName << std::endl;
+
     try {
-        // Load the image
-        std::cout << "\nLoading image..." << std::endl;
-        Image img = Image::loadFromFile(imagePath);
-        std::cout << "Image loaded successfully: " << img.getWidth() << "x" << img.getHeight() 
-                  << " (" << img.getChannels() << " channels)" << std::endl;
-        
-        // Apply edge detection with user's chosen operator
-        std::cout << "\nApplying " << operatorName << " edge detection..." << std::endl;
-        Image edgeResult = EdgeDetector::detectEdges(img, operatorName);
-        
+        EdgeDetectionOptions options = detectionOptions(commandLine);
+        std::string extension = outputExtension(commandLine, "png");
+        PngOptions png = pngOptions(commandLine, options);
+
         // Create output directory if it doesn't exist
-        std::string outputDir = "output";
+        std::string outputDir = commandLine.get("--output-dir", "output");
         std::filesystem::create_directories(outputDir);
 
-        // Generate output filename in the output folder
-        std::string outputPath = outputDir + "/result_" + operatorName + "_edges.png";
+        // Generate output filenames in the output folder; a comma-separated list of
+        // operators shares one pass and each result gets its own file
+        std::vector<std::string> operatorNames = splitOperators(operatorName);
+        std::vector<std::string> outputPaths;
+        for (const std::string& name : operatorNames) {
+            outputPaths.push_back(outputDir + "/result_" + name + "_edges" + extension);
+        }
+
+        // Cached results are copied without decoding the input; any miss computes all results
+        std::unique_ptr<ResultCache> cache = resultCache(commandLine);
+        std::vector<std::string> cacheKeys;
+        if (cache) {
+            uint64_t contentHash = ResultCache::fileHash(imagePath);
+            bool allCached = true;
+            for (size_t i = 0; i < operatorNames.size(); ++i) {
+                cacheKeys.push_back(ResultCache::key(
+                    contentHash, cacheSettings(commandLine, operatorNames[i], options, png, extension)));
+                allCached = cache->fetch(cacheKeys.back(), outputPaths[i]) && allCached;
+            }
+            if (allCached) {
+                std::cout << "\n😊 Edge detection completed successfully (from cache)!" << std::endl;
+                for (const std::string& outputPath : outputPaths) {
+                    std::cout << "Result saved to: " << outputPath << std::endl;
+                }
+                printCacheStats(*cache);
+                return 0;
+            }
+        }
+
+        // Load the image (PGM/PPM and raw inputs are memory-mapped, not decoded)
+        std::cout << "\nLoading image..." << std::endl;
+        Image img = commandLine.has("--raw-size") ? loadRaw(imagePath, commandLine) : Image::loadFromFile(imagePath, loadOptions(commandLine));
+        std::cout << "Image loaded successfully: " << img.getWidth() << "x" << img.getHeight()
+                  << " (" << img.getChannels() << " channels)" << std::endl;
+
+        if (operatorNames.size() > 1) {
+            std::cout << "\nApplying " << operatorName << " edge detection in one pass..." << std::endl;
+            std::vector<Image> results = EdgeDetector::detectEdgesMulti(img.view(), operatorNames, options);
+
+            std::cout << "\nSaving results..." << std::endl;
+            for (size_t i = 0; i < results.size(); ++i) {
+                results[i].saveToFile(outputPaths[i], png);
+            }
+        } else {
+            detectSingle(commandLine, img, operatorName, options, png, extension, outputPaths[0]);
+        }
+
+        for (size_t i = 0; cache && i < outputPaths.size(); ++i) {
+            cache->store(cacheKeys[i], outputPaths[i]);
+        }
 
-        // Save the result
-        std::cout << "\nSaving result..." << std::endl;
-        edgeResult.saveToFile(outputPath);
-        
         std::cout << "\n😊 Edge detection completed successfully!" << std::endl;
-        std::cout << "Result saved to: " << outputPath << std::endl;
-        
+        for (const std::string& outputPath : outputPaths) {
+            std::cout << "Result saved to: " << outputPath << std::endl;
+        }
+        if (cache) {
+            printCacheStats(*cache);
+        }
+
     } catch (const std::exception& e) {
         std::cout << "\n❌ Error: " << e.what() << std::endl;
         return 1;
     }
-    
+
     return 0;
-}
\ No newline at end of file
+}
+
+int runServe(const CommandLine& commandLine) {
+    ServerOptions options;
+    options.socketPath = commandLine.positional[0];
+    std::string workers = commandLine.get("--workers", "0");
+
+    try {
+        options.workers = static_cast<unsigned>(std::stoul(workers));
+    } catch (const std::exception&) {
+        std::cout << "❌ Error: Invalid worker count: " << workers << std::endl;
+        return 1;
+    }
+
+    // --tile auto calibrates here, once, rather than on the first request
+    try {
+        options.tiles = detectionOptions(commandLine).tiles;
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // SIGINT/SIGTERM are blocked in every thread and collected by sigwait, which
+    // can call stop() safely outside of a signal handler
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        EdgeServer server(options);
+        std::cout << "Edge Detection Program (serve mode)" << std::endl;
+        std::cout << "Listening on: " << server.socketPath() << std::endl;
+
+        std::thread signalWatcher([&server, signals] {
+            int signal = 0;
+            sigwait(&signals, &signal);
+            server.stop();
+        });
+
+        // The watcher must be joined however run() ends. SIGTERM sent to it directly ends
+        // its sigwait if no signal arrived yet; the watcher then calls stop() again, which is harmless
+        auto stopWatcher = [&signalWatcher] {
+            pthread_kill(signalWatcher.native_handle(), SIGTERM);
+            signalWatcher.join();
+        };
+        try {
+            server.run();
+        } catch (...) {
+            stopWatcher();
+            throw;
+        }
+        stopWatcher();
+        std::cout << "Server stopped" << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "\n❌ Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int run(const CommandLine& commandLine) {
+    if (commandLine.has("--serve")) {
+        return runServe(commandLine);
+    }
+    if (commandLine.has("--batch")) {
+        return runBatch(commandLine);
+    }
+    if (commandLine.has("--stream")) {
+        return runStream(commandLine);
+    }
+    return runSingle(commandLine);
+}
+
+int main(int argc, char* argv[]) {
+    // Check command line arguments
+    CommandLine commandLine;
+    if (!parseCommandLine(argc, argv, commandLine)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (!commandLine.has("--profile")) {
+        return run(commandLine);
+    }
+
+    Profiler::enable();
+    int status = run(commandLine);
+    Profiler::enable(false);
+    std::cout << "\n" << Profiler::summary();
+
+    std::string tracePath = commandLine.get("--output-dir", "output") + "/profile_trace.json";
+    try {
+        Profiler::writeChromeTrace(tracePath);
+        std::cout << "Trace saved to: " << tracePath << std::endl;
+    } catch (const std::exception& e) {
+        std::cout << "❌ Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return status;
+}
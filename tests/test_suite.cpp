@@ -13,10 +13,90 @@
 #include <iomanip>
 #include <cassert>
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <array>
+#include <set>
 #include "../include/Image.h"
 #include "../include/EdgeDetector.h"
+#include "../include/GradientKernels.h"
+#include "../include/ThreadPool.h"
+#include "../include/BatchProcessor.h"
+#include "../include/PnmIO.h"
+#include "../include/Profiler.h"
+#include "../include/BufferPool.h"
+#include "../include/EdgeServer.h"
+#include "../include/TileTuning.h"
+#include "../include/FrameSequence.h"
+#include "../include/ResultCache.h"
+#include "../include/EdgePipeline.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
 
 
+// Counts heap allocations so tests can check allocation-free steady states. The whole
+// operator new/delete family is replaced so every form pairs with a matching release
+static std::atomic<size_t> heapAllocations{0};
+
+static void* countedAllocate(size_t size, size_t alignment = 0) noexcept {
+    ++heapAllocations;
+    size = size ? size : 1;
+    if (alignment > alignof(std::max_align_t)) {
+        // aligned_alloc needs a size that is a multiple of the alignment
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    return std::malloc(size);
+}
+
+static void* countedAllocateOrThrow(size_t size, size_t alignment = 0) {
+    if (void* memory = countedAllocate(size, alignment)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return countedAllocateOrThrow(size); }
+void* operator new[](size_t size) { return countedAllocateOrThrow(size); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    return countedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return countedAllocateOrThrow(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+
 //Test framework
 void runTest(const std::string& testName, bool (*testFunc)()) {
     std::cout << "Running: " << testName << "... ";
@@ -31,6 +111,16 @@ void runTest(const std::string& testName, bool (*testFunc)()) {
     }
 }
 
+// Deterministic pseudo-random test pattern (LCG) so failures are reproducible
+std::vector<uint8_t> makeNoiseImage(int width, int height, int channels, uint32_t seed = 12345) {
+    std::vector<uint8_t> data(static_cast<size_t>(width) * height * channels);
+    for (auto& value : data) {
+        seed = seed * 1664525u + 1013904223u;
+        value = static_cast<uint8_t>(seed >> 24);
+    }
+    return data;
+}
+
 // =============================================================================
 // UNIT TESTS - IMAGE CLASS (Loading/Saving)
 // =============================================================================
@@ -79,6 +169,209 @@ bool test_image_constructor_data_size_mismatch() {
     }
 }
 
+bool test_image_adopts_buffer_without_copying() {
+    // Test: An adopted buffer is shared by copies and released once by its deleter
+    static int releases = 0;
+    releases = 0;
+    uint8_t* buffer = new uint8_t[12]();
+    {
+        Image image(std::shared_ptr<const uint8_t>(buffer, [](const uint8_t* p) {
+            delete[] p;
+            ++releases;
+        }), 4, 3, 1);
+        Image copy = image;
+        Image gray = copy.toGrayscale();
+
+        if (image.getData().data() != buffer || copy.getData().data() != buffer ||
+            gray.getData().data() != buffer || image.getData().size() != 12) {
+            return false;
+        }
+    }
+    return releases == 1;
+}
+
+bool test_image_mapped_pnm_and_raw_round_trip() {
+    // Test: PGM/PPM/raw files are written and mapped back without decoding, pixel for pixel
+    namespace fs = std::filesystem;
+    fs::path ppmPath = fs::temp_directory_path() / "edge_mapped_test.ppm";
+    fs::path rawPath = fs::temp_directory_path() / "edge_mapped_test.raw";
+
+    try {
+        Image original(makeNoiseImage(11, 7, 3), 11, 7, 3);
+        original.saveToFile(ppmPath.string());
+        original.saveToFile(rawPath.string());
+
+        Image mapped = Image::loadFromFile(ppmPath.string());
+        Image raw = Image::loadRaw(rawPath.string(), 11, 7, 3);
+        bool success = mapped.getWidth() == 11 && mapped.getHeight() == 7 && mapped.getChannels() == 3 &&
+                       mapped.getData() == original.getData() && raw.getData() == original.getData() &&
+                       fs::file_size(rawPath) == original.getDataSize();
+
+        // Saving over the file backing a mapping replaces the file, not the mapped pixels
+        Image reloaded = Image::loadFromFile(ppmPath.string());
+        reloaded.saveToFile(ppmPath.string());
+        std::vector<uint8_t> inverted(original.getData().begin(), original.getData().end());
+        for (uint8_t& value : inverted) {
+            value = static_cast<uint8_t>(255 - value);
+        }
+        Image(inverted, 11, 7, 3).saveToFile(ppmPath.string());
+        success = success && reloaded.getData() == original.getData() &&
+                  Image::loadFromFile(ppmPath.string()).getData() == inverted;
+        for (const auto& entry : fs::directory_iterator(ppmPath.parent_path())) {
+            if (entry.path().filename().string().rfind("edge_mapped_test.ppm.tmp", 0) == 0) {
+                success = false;  // Temporary files are renamed into place
+            }
+        }
+        original.saveToFile(ppmPath.string());
+
+        // Mappings stay valid after the files are unlinked
+        fs::remove(ppmPath);
+        fs::remove(rawPath);
+        Image edges = EdgeDetector::detectEdges(mapped, "Sobel");
+        success = success && edges.getData() == EdgeDetector::detectEdges(original, "Sobel").getData();
+
+        // Geometry that does not match the raw file size is rejected
+        original.saveToFile(rawPath.string());
+        try {
+            Image::loadRaw(rawPath.string(), 7, 11, 1);
+            success = false;
+        } catch (const std::runtime_error&) {
+        }
+        fs::remove(rawPath);
+        return success;
+
+    } catch (const std::exception& e) {
+        std::cout << "\n  Mapped I/O test failed: " << e.what() << std::endl;
+        fs::remove(ppmPath);
+        fs::remove(rawPath);
+        return false;
+    }
+}
+
+bool test_image_fixed_point_grayscale_and_luma_load() {
+    // Test: SIMD and scalar tails both follow the Q16 formula, for every standard,
+    // channel count and thread count, and loading with grayscale gives the same luma
+    namespace fs = std::filesystem;
+    fs::path pngPath = fs::temp_directory_path() / "edge_luma_test.png";
+    fs::path ppmPath = fs::temp_directory_path() / "edge_luma_test.ppm";
+
+    try {
+        bool success = true;
+        const std::pair<LumaWeights, std::array<int, 3>> standards[] = {
+            {LumaWeights::BT601, {19595, 38470, 7471}}, {LumaWeights::BT709, {13933, 46871, 4732}}};
+        for (const auto& [luma, weights] : standards) {
+            for (int channels : {3, 4}) {
+                for (size_t count : {1, 27, 31, 32, 33, 64, 95, 1000}) {
+                    std::vector<uint8_t> source = makeNoiseImage(static_cast<int>(count), 1, channels);
+                    std::vector<uint8_t> gray(count);
+                    Image::convertToGrayscale(source.data(), gray.data(), count, channels, luma);
+                    for (size_t i = 0; i < count; ++i) {
+                        const uint8_t* pixel = &source[i * channels];
+                        int expected = (weights[0] * pixel[0] + weights[1] * pixel[1] + weights[2] * pixel[2]) >> 16;
+                        success = success && gray[i] == expected;
+                    }
+                }
+            }
+
+            // Weights sum to 1.0, so gray pixels keep their value
+            std::vector<uint8_t> grays(256 * 3), converted(256);
+            for (int value = 0; value < 256; ++value) {
+                std::fill_n(&grays[value * 3], 3, static_cast<uint8_t>(value));
+            }
+            Image::convertToGrayscale(grays.data(), converted.data(), 256, 3, luma);
+            for (int value = 0; value < 256; ++value) {
+                success = success && converted[value] == value;
+            }
+        }
+
+        Image color(makeNoiseImage(37, 29, 3), 37, 29, 3);
+        Image serial = color.toGrayscale(LumaWeights::BT709);
+        success = success && color.toGrayscale(LumaWeights::BT709, 4).getData() == serial.getData();
+
+        // Decoded and memory-mapped inputs are converted while loading
+        color.saveToFile(pngPath.string());
+        color.saveToFile(ppmPath.string());
+        LoadOptions load;
+        load.grayscale = true;
+        load.luma = LumaWeights::BT709;
+        for (const fs::path& path : {pngPath, ppmPath}) {
+            Image loaded = Image::loadFromFile(path.string(), load);
+            success = success && loaded.getChannels() == 1 && loaded.getData() == serial.getData();
+        }
+        fs::remove(pngPath);
+        fs::remove(ppmPath);
+
+        success = success && Image::parseLuma("bt.709") == LumaWeights::BT709;
+        try {
+            Image::parseLuma("BT2020");
+            success = false;
+        } catch (const std::invalid_argument&) {
+        }
+        return success;
+
+    } catch (const std::exception& e) {
+        std::cout << "\n  Grayscale test failed: " << e.what() << std::endl;
+        fs::remove(pngPath);
+        fs::remove(ppmPath);
+        return false;
+    }
+}
+
+bool test_image_in_memory_decode_and_encode() {
+    // Test: Images round-trip through memory without files, the PNG buffer is reused,
+    // and the callback stream is byte-identical to the buffered encoding
+    try {
+        Image color(makeNoiseImage(300, 200, 3), 300, 200, 3);
+        bool success = true;
+        std::vector<uint8_t> buffer;
+        for (unsigned threads : {1u, 3u}) {
+            PngOptions options;
+            options.threads = threads;
+            options.compressionLevel = 1;
+            color.encodePng(buffer, options);
+            const uint8_t* first = buffer.data();
+            color.encodePng(buffer, options);
+
+            std::vector<uint8_t> streamed;
+            size_t pieces = 0;
+            color.encodeToCallback([&](const uint8_t* data, size_t size) {
+                streamed.insert(streamed.end(), data, data + size);
+                ++pieces;
+            }, options);
+
+            Image decoded = Image::loadFromMemory(buffer);
+            success = success && buffer.data() == first && streamed == buffer && pieces >= 3 &&
+                      decoded.getWidth() == 300 && decoded.getChannels() == 3 && decoded.getData() == color.getData();
+        }
+
+        // Grayscale at load time, and Netpbm bytes without a file
+        LoadOptions load;
+        load.grayscale = true;
+        success = success && Image::loadFromMemory(buffer, load).getData() == color.toGrayscale().getData();
+        std::string header = PnmIO::formatHeader(300, 200, 3);
+        std::vector<uint8_t> ppm(header.begin(), header.end());
+        ppm.insert(ppm.end(), color.getData().begin(), color.getData().end());
+        success = success && Image::loadFromMemory(ppm).getData() == color.getData();
+
+        try {
+            Image::loadFromMemory(ByteSpan(nullptr, 0));
+            success = false;
+        } catch (const std::invalid_argument&) {
+        }
+        try {
+            std::vector<uint8_t> garbage(64, 0x42);
+            Image::loadFromMemory(garbage);
+            success = false;
+        } catch (const std::runtime_error&) {
+        }
+        return success;
+
+    } catch (const std::exception& e) {
+        std::cout << "\n  In-memory I/O test failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
 // B. File Loading Tests
 bool test_image_load_nonexistent_file() {
     // Test: Loading non-existent file should throw
@@ -133,6 +426,53 @@ bool test_image_save_invalid_image_data() {
     }
 }
 
+bool test_image_save_png_options_round_trip() {
+    // Test: Every PNG level/filter/thread setting decodes back to the original pixels,
+    // and chunked parallel encoding is byte-identical to single-threaded encoding
+    const std::string path = "test_png_options.png";
+    try {
+        for (int channels = 1; channels <= 4; ++channels) {
+            Image original(makeNoiseImage(29, 13, channels, 7 + channels), 29, 13, channels);
+            for (int level : {0, 1, 6, 9}) {
+                for (PngFilter filter : {PngFilter::None, PngFilter::Sub, PngFilter::Up, PngFilter::Average,
+                                         PngFilter::Paeth, PngFilter::Adaptive}) {
+                    PngOptions options;
+                    options.compressionLevel = level;
+                    options.filter = filter;
+                    original.saveToFile(path, options);
+                    Image loaded = Image::loadFromFile(path);
+                    if (loaded.getChannels() != channels || loaded.getData() != original.getData()) {
+                        std::remove(path.c_str());
+                        return false;
+                    }
+                }
+            }
+        }
+
+        // Large enough for several independently compressed chunks
+        std::vector<uint8_t> smooth(700 * 1200);
+        for (size_t i = 0; i < smooth.size(); ++i) {
+            smooth[i] = static_cast<uint8_t>((i % 700) / 3 + (i / 700) % 17);
+        }
+        Image large(smooth, 700, 1200, 1);
+        PngOptions serial, parallel;
+        parallel.threads = 4;
+        std::vector<uint8_t> serialBytes = PngEncoder::encode(large.view(), serial);
+        bool success = serialBytes == PngEncoder::encode(large.view(), parallel) &&
+                       serialBytes.size() < smooth.size() / 4;
+
+        large.saveToFile(path, parallel);
+        success = success && Image::loadFromFile(path).getData() == large.getData();
+        std::remove(path.c_str());
+        return success;
+
+    } catch (const std::exception& e) {
+        std::cout << "\n  PNG options test failed: " << e.what() << std::endl;
+        std::remove(path.c_str());
+        return false;
+    }
+}
+
 // =============================================================================
 // EDGEDETECTOR CLASS TEST  
 // =============================================================================
@@ -280,6 +620,899 @@ bool test_edge_detector_uniform_image() {
     return lowValuePixels >= 20;
 }
 
+// Reference: direct 3x3 convolution with replicated borders and Euclidean magnitude
+std::vector<uint8_t> referenceEdges(const std::vector<uint8_t>& gray, int width, int height,
+                                    const int kx[3][3], const int ky[3][3]) {
+    std::vector<uint8_t> result(gray.size());
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            int gx = 0, gy = 0;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int sy = std::min(std::max(y + dy, 0), height - 1);
+                    int sx = std::min(std::max(x + dx, 0), width - 1);
+                    int pixel = gray[sy * width + sx];
+                    gx += pixel * kx[dy + 1][dx + 1];
+                    gy += pixel * ky[dy + 1][dx + 1];
+                }
+            }
+            double magnitude = std::sqrt(static_cast<double>(gx) * gx + static_cast<double>(gy) * gy);
+            result[y * width + x] = static_cast<uint8_t>(std::min(255.0, magnitude));
+        }
+    }
+    return result;
+}
+
+bool test_edge_detector_separable_matches_direct_convolution() {
+    // Test: Separable row/column passes must be bit-identical to the full 3x3 kernels
+    const int sobelX[3][3] = {{-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1}};
+    const int sobelY[3][3] = {{-1, -2, -1}, {0, 0, 0}, {1, 2, 1}};
+    const int prewittX[3][3] = {{-1, 0, 1}, {-1, 0, 1}, {-1, 0, 1}};
+    const int prewittY[3][3] = {{-1, -1, -1}, {0, 0, 0}, {1, 1, 1}};
+
+    int width = 37, height = 23;
+    std::vector<uint8_t> gray = makeNoiseImage(width, height, 1);
+    Image image(gray, width, height, 1);
+
+    return EdgeDetector::detectEdges(image, "Sobel").getData() ==
+               referenceEdges(gray, width, height, sobelX, sobelY) &&
+           EdgeDetector::detectEdges(image, "Prewitt").getData() ==
+               referenceEdges(gray, width, height, prewittX, prewittY);
+}
+
+// Non-separable policy: exercises the unrolled kernel for custom operators
+struct DiagonalOperator {
+    static constexpr const char* name = "Diagonal";
+    static constexpr int kernelX[3][3] = {{0, 1, 2}, {-1, 0, 1}, {-2, -1, 0}};
+    static constexpr int kernelY[3][3] = {{-2, -1, 0}, {-1, 0, 1}, {0, 1, 2}};
+};
+
+bool test_edge_detector_scharr_and_custom_operators() {
+    // Test: Scharr and compile-time operator policies match direct convolution,
+    // and template/enum/string dispatch agree for built-in operators
+    int width = 41, height = 17;
+    std::vector<uint8_t> gray = makeNoiseImage(width, height, 1);
+    Image image(gray, width, height, 1);
+
+    bool scharrMatches = EdgeDetector::detectEdges(image, "scharr").getData() ==
+                         referenceEdges(gray, width, height, ScharrOperator::kernelX, ScharrOperator::kernelY);
+    bool customMatches = EdgeDetector::detectEdges<DiagonalOperator>(image.view()).getData() ==
+                         referenceEdges(gray, width, height, DiagonalOperator::kernelX, DiagonalOperator::kernelY);
+
+    // The custom kernel honours the norm and writes into caller-provided buffers
+    EdgeDetectionOptions l1;
+    l1.norm = GradientNorm::L1;
+    EdgeDetector::Workspace workspace;
+    std::vector<uint8_t> customL1(gray.size());
+    EdgeDetector::detectEdgesInto<DiagonalOperator>(image.view(), customL1.data(), width, workspace, l1);
+    bool customNormMatches = customL1[width + 1] == std::min(255,
+        std::abs(-gray[1] - 2 * gray[2] + gray[width] - gray[width + 2] + 2 * gray[2 * width] + gray[2 * width + 1]) +
+        std::abs(-2 * gray[0] - gray[1] - gray[width] + gray[width + 2] + gray[2 * width + 1] + 2 * gray[2 * width + 2]));
+
+    bool dispatchAgrees =
+        EdgeDetector::detectEdges<SobelOperator>(image.view()).getData() ==
+            EdgeDetector::detectEdges(image, "Sobel").getData() &&
+        EdgeDetector::detectEdges(image.view(), EdgeOperator::Prewitt).getData() ==
+            EdgeDetector::detectEdges(image, "PREWITT").getData();
+
+    bool parsesScharr = EdgeDetector::parseOperator("ScHaRr") == EdgeOperator::Scharr;
+    return scharrMatches && customMatches && customNormMatches && dispatchAgrees && parsesScharr;
+}
+
+// Vertical step between columns 29 and 30: stepHeight(y) on rows where it is positive
+Image makeStepImage(int width, int height, const std::function<int(int)>& stepHeight) {
+    std::vector<uint8_t> data(static_cast<size_t>(width) * height, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 30; x < width; ++x) {
+            data[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>(stepHeight(y));
+        }
+    }
+    return Image(data, width, height, 1);
+}
+
+bool test_edge_detector_canny_thin_edges_and_hysteresis() {
+    // Test: A step of height h has smoothed Sobel magnitude 3h. With thresholds 40/100,
+    // h = 100 seeds an edge; the step then fades by 2 per row (too gentle to form edges
+    // itself) to h = 20 (magnitude 60), which survives only because it is connected
+    int width = 60, height = 64;
+    CannyOptions options;
+    options.lowThreshold = 40;
+    options.highThreshold = 100;
+
+    Image connected = makeStepImage(width, height, [](int y) { return std::max(20, 100 - 2 * std::max(0, y - 4)); });
+    Image serial = EdgeDetector::detectCanny(connected.view(), options);
+    const auto& edges = serial.getData();
+
+    // Every row has exactly one edge pixel, on one side of the step
+    bool thinAndConnected = true;
+    for (int y = 2; y < height - 2; ++y) {
+        int count = 0;
+        for (int x = 0; x < width; ++x) {
+            count += edges[static_cast<size_t>(y) * width + x] == 255;
+        }
+        const uint8_t* step = &edges[static_cast<size_t>(y) * width + 29];
+        thinAndConnected &= count == 1 && (step[0] == 255 || step[1] == 255);
+    }
+
+    bool binary = std::all_of(edges.begin(), edges.end(), [](uint8_t v) { return v == 0 || v == 255; });
+
+    // Many thin bands: the weak edge must be followed across every band seam
+    options.threads = 4;
+    bool parallelMatches = EdgeDetector::detectCanny(connected.view(), options).getData() == serial.getData();
+
+    // Weak edges without a strong seed are dropped entirely
+    Image weakOnly = makeStepImage(width, height, [](int) { return 20; });
+    const auto weakEdges = EdgeDetector::detectCanny(weakOnly.view(), options);
+    bool weakDropped = std::all_of(weakEdges.getData().begin(), weakEdges.getData().end(),
+                                   [](uint8_t v) { return v == 0; });
+
+    try {
+        options.lowThreshold = 120;
+        EdgeDetector::detectCanny(connected.view(), options);
+        return false; // Should have thrown: low above high
+    } catch (const std::invalid_argument&) {
+    }
+
+    return thinAndConnected && binary && parallelMatches && weakDropped;
+}
+
+bool test_edge_detector_l1_and_linf_norms() {
+    // Test: L1 and L-infinity norms clamp |gx|+|gy| and max(|gx|,|gy|) to 255
+    // Vertical step of 40: Sobel gx = 4 * 40 = 160 at the step, gy = 0
+    std::vector<uint8_t> step = {
+        0, 0, 40, 40,
+        0, 0, 40, 40,
+        0, 0, 40, 40
+    };
+    Image image(step, 4, 3, 1);
+
+    EdgeDetectionOptions l1;
+    l1.norm = EdgeDetector::parseNorm("L1");
+    EdgeDetectionOptions linf;
+    linf.norm = EdgeDetector::parseNorm("linf");
+
+    Image l1Result = EdgeDetector::detectEdges(image, "Sobel", l1);
+    Image linfResult = EdgeDetector::detectEdges(image, "Sobel", linf);
+    const auto& l1Data = l1Result.getData();
+    const auto& linfData = linfResult.getData();
+
+    // Diagonal step: gx = gy = 4 * 100 = 400 at the corner, saturating L1 and L-infinity
+    std::vector<uint8_t> corner(16, 0);
+    corner[15] = 100;
+    Image cornerResult = EdgeDetector::detectEdges(Image(corner, 4, 4, 1), "Prewitt", l1);
+    const auto& cornerL1 = cornerResult.getData();
+
+    try {
+        EdgeDetector::parseNorm("L3");
+        return false; // Should have thrown
+    } catch (const std::invalid_argument&) {
+    }
+
+    return l1Data[1] == 160 && l1Data[2] == 160 && l1Data[0] == 0 &&
+           linfData[1] == 160 && linfData[5] == 160 && linfData[3] == 0 &&
+           cornerL1[15] == 255 && cornerL1[10] == 200;
+}
+
+bool test_gradient_kernels_variants_match_scalar() {
+    // Test: Every SIMD variant available on this CPU matches the scalar reference,
+    // including row tails and saturated (0/255) gradients
+    std::string original = GradientKernels::active().name;
+    bool allMatch = true;
+
+    for (int width = 3; width <= 70 && allMatch; width += 7) {
+        int height = 9;
+        std::vector<uint8_t> noise = makeNoiseImage(width, height, 1, width);
+        std::vector<uint8_t> checker(noise.size());
+        for (size_t i = 0; i < checker.size(); ++i) {
+            checker[i] = ((i % width + i / width) % 2) ? 255 : 0;
+        }
+
+        for (const auto& data : {noise, checker}) {
+            Image image(data, width, height, 1);
+            for (GradientNorm norm : {GradientNorm::L2, GradientNorm::L1, GradientNorm::LInf}) {
+                EdgeDetectionOptions options;
+                options.norm = norm;
+                for (EdgeOperator op : {EdgeOperator::Sobel, EdgeOperator::Prewitt, EdgeOperator::Scharr}) {
+                    GradientKernels::select("scalar");
+                    Image reference = EdgeDetector::detectEdges(image.view(), op, options);
+
+                    for (const auto& variant : GradientKernels::available()) {
+                        GradientKernels::select(variant.name);
+                        if (EdgeDetector::detectEdges(image.view(), op, options).getData() != reference.getData()) {
+                            std::cout << "\n  Variant '" << variant.name << "' differs at width " << width;
+                            allMatch = false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Grayscale conversion follows the selected variant; every one matches the Q16 formula
+    const size_t pixelCount = 101;
+    for (int channels : {3, 4}) {
+        std::vector<uint8_t> color = makeNoiseImage(static_cast<int>(pixelCount), 1, channels);
+        std::vector<uint8_t> expected(pixelCount), gray(pixelCount);
+        for (size_t i = 0; i < pixelCount; ++i) {
+            const uint8_t* pixel = &color[i * channels];
+            expected[i] = static_cast<uint8_t>((19595 * pixel[0] + 38470 * pixel[1] + 7471 * pixel[2]) >> 16);
+        }
+        for (const auto& variant : GradientKernels::available()) {
+            GradientKernels::select(variant.name);
+            Image::convertToGrayscale(color.data(), gray.data(), pixelCount, channels, LumaWeights::BT601);
+            if (gray != expected) {
+                std::cout << "\n  Variant '" << variant.name << "' converts " << channels << " channels differently";
+                allMatch = false;
+            }
+        }
+    }
+
+    GradientKernels::select(original);
+    return allMatch;
+}
+
+bool test_edge_detector_gradient_planes_and_orientation() {
+    // Test: gx/gy planes match direct convolution on every variant, the magnitude is
+    // unchanged, and orientation bins follow the gradient direction
+    int width = 70, height = 11;
+    std::vector<uint8_t> gray = makeNoiseImage(width, height, 1);
+    Image image(gray, width, height, 1);
+    std::string original = GradientKernels::active().name;
+    bool planesMatch = true;
+
+    for (const auto& variant : GradientKernels::available()) {
+        GradientKernels::select(variant.name);
+        GradientField field = EdgeDetector::detectGradients(image.view(), "Scharr");
+        planesMatch = planesMatch && field.magnitude.getData() == EdgeDetector::detectEdges(image, "Scharr").getData();
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int gx = 0, gy = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int pixel = gray[std::min(std::max(y + dy, 0), height - 1) * width +
+                                         std::min(std::max(x + dx, 0), width - 1)];
+                        gx += pixel * ScharrOperator::kernelX[dy + 1][dx + 1];
+                        gy += pixel * ScharrOperator::kernelY[dy + 1][dx + 1];
+                    }
+                }
+                planesMatch = planesMatch && field.gx[y * width + x] == gx && field.gy[y * width + x] == gy;
+            }
+        }
+    }
+    GradientKernels::select(original);
+
+    // Orientation alone (gx/gy kept in scratch) on several threads matches the full field
+    GradientField field = EdgeDetector::detectGradients(image.view(), "Sobel", 4);
+    std::vector<uint8_t> magnitude(gray.size()), orientation(gray.size());
+    GradientPlanes planes;
+    planes.magnitude = magnitude.data();
+    planes.magnitudeStride = width;
+    planes.orientation = orientation.data();
+    planes.orientationStride = width;
+    planes.orientationBins = 4;
+    EdgeDetectionOptions parallel;
+    parallel.threads = 4;
+    EdgeDetector::Workspace workspace;
+    EdgeDetector::detectGradientsInto(image.view(), EdgeOperator::Sobel, planes, workspace, parallel);
+    bool scratchMatches = orientation == field.orientation.getData() && magnitude == field.magnitude.getData();
+
+    // Directions in image coordinates (y down), 45 degrees per bin
+    const int16_t gx[] = {10, 10, 0, -10, -10, -10, 0, 10, 0, 10, 10};
+    const int16_t gy[] = {0, 10, 10, 10, 0, -10, -10, -10, 0, 3, 5};
+    const uint8_t expected[] = {0, 1, 2, 3, 4, 5, 6, 7, 0, 0, 1};
+    uint8_t eight[11], four[11];
+    GradientKernels::orientationRow(gx, gy, eight, 11, 8);
+    GradientKernels::orientationRow(gx, gy, four, 11, 4);
+    bool binsCorrect = true;
+    for (int i = 0; i < 11; ++i) {
+        binsCorrect = binsCorrect && eight[i] == expected[i] && four[i] == expected[i] % 4;
+    }
+
+    bool rejectsBins = false;
+    planes.orientationBins = 6;
+    try {
+        EdgeDetector::detectGradientsInto(image.view(), EdgeOperator::Sobel, planes, workspace);
+    } catch (const std::invalid_argument&) {
+        rejectsBins = true;
+    }
+    return planesMatch && scratchMatches && binsCorrect && rejectsBins;
+}
+
+bool test_edge_detector_regions_match_full_frame_crops() {
+    // Test: Each region equals the same crop of the full-frame result, replicating borders
+    // only at real image edges, and pixels beyond the 1-pixel halo are never read
+    int width = 53, height = 29, channels = 3;
+    std::vector<uint8_t> data = makeNoiseImage(width, height, channels);
+    Image image(data, width, height, channels);
+    std::vector<Rect> regions = {{0, 0, 7, 5}, {46, 24, 7, 5}, {10, 3, 40, 20}, {0, 12, 53, 1}, {52, 0, 1, 29},
+                                 {20, 10, 1, 1}};
+
+    EdgeDetectionOptions parallel;
+    parallel.threads = 4;
+    Image full = EdgeDetector::detectEdges(image, "Sobel");
+    std::vector<Image> serialResults = EdgeDetector::detectEdgesInRegions(image.view(), "Sobel", regions);
+    std::vector<Image> parallelResults = EdgeDetector::detectEdgesInRegions(image.view(), "sobel", regions, parallel);
+
+    bool cropsMatch = serialResults.size() == regions.size();
+    for (size_t i = 0; i < regions.size() && cropsMatch; ++i) {
+        const Rect& region = regions[i];
+        for (int y = 0; y < region.height; ++y) {
+            for (int x = 0; x < region.width; ++x) {
+                uint8_t expected = full.getData()[(region.y + y) * width + region.x + x];
+                cropsMatch = cropsMatch && serialResults[i].getData()[y * region.width + x] == expected &&
+                             parallelResults[i].getData()[y * region.width + x] == expected;
+            }
+        }
+    }
+
+    // Scribble over everything outside region + halo: the result must not change
+    Rect region{10, 3, 40, 20};
+    std::vector<uint8_t> poisoned = data;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (y < region.y - 1 || y > region.y + region.height || x < region.x - 1 || x > region.x + region.width) {
+                std::fill_n(poisoned.begin() + (y * width + x) * channels, channels, 255);
+            }
+        }
+    }
+    std::vector<uint8_t> output(static_cast<size_t>(region.width + 3) * region.height);
+    EdgeDetector::Workspace workspace;
+    ImageView poisonedView{poisoned.data(), width, height, channels, static_cast<size_t>(width) * channels};
+    EdgeDetector::detectRegionInto(poisonedView, EdgeOperator::Sobel, region, output.data(), region.width + 3,
+                                   workspace);
+    bool haloOnly = true;
+    for (int y = 0; y < region.height; ++y) {
+        haloOnly = haloOnly && std::equal(output.begin() + y * (region.width + 3),
+                                          output.begin() + y * (region.width + 3) + region.width,
+                                          serialResults[2].getData().begin() + y * region.width);
+    }
+
+    bool rejectsOutside = false;
+    try {
+        EdgeDetector::detectEdgesInRegions(image.view(), "Sobel", {{50, 0, 4, 4}});
+    } catch (const std::invalid_argument&) {
+        rejectsOutside = true;
+    }
+    return cropsMatch && haloOnly && rejectsOutside;
+}
+
+bool test_edge_detector_fused_color_matches_grayscale_input() {
+    // Test: On-the-fly RGB/RGBA conversion matches converting with toGrayscale() first
+    int width = 19, height = 13;
+    for (int channels : {3, 4}) {
+        Image color(makeNoiseImage(width, height, channels), width, height, channels);
+        if (EdgeDetector::detectEdges(color, "Prewitt").getData() !=
+            EdgeDetector::detectEdges(color.toGrayscale(), "Prewitt").getData()) {
+            return false;
+        }
+    }
+
+    // Two-channel images are still rejected like toGrayscale() does
+    try {
+        Image grayAlpha(makeNoiseImage(width, height, 2), width, height, 2);
+        EdgeDetector::detectEdges(grayAlpha, "Sobel");
+        return false; // Should have thrown
+    } catch (const std::runtime_error&) {
+        return true; // Expected
+    }
+}
+
+bool test_edge_detector_strided_view_matches_cropped_image() {
+    // Test: A view into a sub-rectangle of a larger buffer gives the same result
+    // as an Image holding exactly those pixels
+    int fullWidth = 30, fullHeight = 20, channels = 3;
+    std::vector<uint8_t> full = makeNoiseImage(fullWidth, fullHeight, channels);
+
+    int cropX = 5, cropY = 4, cropWidth = 17, cropHeight = 11;
+    std::vector<uint8_t> cropped;
+    for (int y = cropY; y < cropY + cropHeight; ++y) {
+        auto rowStart = full.begin() + (static_cast<size_t>(y) * fullWidth + cropX) * channels;
+        cropped.insert(cropped.end(), rowStart, rowStart + cropWidth * channels);
+    }
+
+    ImageView view{full.data() + (static_cast<size_t>(cropY) * fullWidth + cropX) * channels,
+                   cropWidth, cropHeight, channels, static_cast<size_t>(fullWidth) * channels};
+    Image fromView = EdgeDetector::detectEdges(view, "Sobel");
+    Image fromCrop = EdgeDetector::detectEdges(Image(cropped, cropWidth, cropHeight, channels), "Sobel");
+    return fromView.getData() == fromCrop.getData();
+}
+
+bool test_edge_detector_parallel_matches_serial() {
+    // Test: Band-parallel execution produces the same output for any thread count
+    int width = 41, height = 29;
+    Image image(makeNoiseImage(width, height, 3), width, height, 3);
+    Image serial = EdgeDetector::detectEdges(image, "Sobel");
+
+    for (unsigned threads : {0u, 2u, 3u, 8u}) {
+        EdgeDetectionOptions options;
+        options.threads = threads;
+        if (EdgeDetector::detectEdges(image, "Sobel", options).getData() != serial.getData()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_edge_detector_tiled_matches_untiled_and_tuning_file() {
+    // Test: Any tiling and thread count gives the untiled output, for edges, gradient
+    // planes and regions, and tuning files round-trip and go stale with the kernel variant
+    namespace fs = std::filesystem;
+    fs::path tuningPath = fs::temp_directory_path() / "edge_tiles_test" / "tiles.conf";
+    int width = 53, height = 31;
+    Image image(makeNoiseImage(width, height, 3), width, height, 3);
+    Image expected = EdgeDetector::detectEdges(image, "Sobel");
+    GradientField expectedField = EdgeDetector::detectGradients(image.view(), "Scharr");
+    Rect region{5, 3, 40, 20};
+    Image expectedRegion = EdgeDetector::detectEdgesInRegions(image.view(), "Sobel", {region})[0];
+
+    bool success = true;
+    for (TileSize tiles : {TileSize{1, 1}, TileSize{7, 5}, TileSize{16, 0}, TileSize{0, 3}, TileSize{64, 64}}) {
+        for (unsigned threads : {1u, 3u}) {
+            EdgeDetectionOptions options;
+            options.tiles = tiles;
+            options.threads = threads;
+            GradientField field = EdgeDetector::detectGradients(image.view(), "Scharr", 8, options);
+            success = success && EdgeDetector::detectEdges(image, "Sobel", options).getData() == expected.getData() &&
+                      field.magnitude.getData() == expectedField.magnitude.getData() &&
+                      field.gx == expectedField.gx && field.gy == expectedField.gy &&
+                      field.orientation.getData() == expectedField.orientation.getData() &&
+                      EdgeDetector::detectEdgesInRegions(image.view(), "Sobel", {region}, options)[0].getData() ==
+                          expectedRegion.getData();
+        }
+    }
+
+    try {
+        success = success && !TileTuning::load(tuningPath.string());
+        TileTuning::save(tuningPath.string(), TileSize{512, 32});
+        std::optional<TileSize> loaded = TileTuning::load(tuningPath.string());
+        success = success && loaded && loaded->width == 512 && loaded->height == 32 &&
+                  TileTuning::tuned(tuningPath.string()).width == 512;
+
+        // A file tuned for another row kernel variant is ignored
+        std::string active = GradientKernels::active().name;
+        GradientKernels::select(active == "scalar" ? "sse2" : "scalar");
+        success = success && !TileTuning::load(tuningPath.string());
+        GradientKernels::select(active);
+
+        success = success && TileTuning::format(TileTuning::parse("0x64")) == "0x64";
+        for (const char* invalid : {"64", "64x", "-1x8", "8x8x8"}) {
+            try {
+                TileTuning::parse(invalid);
+                success = false;
+            } catch (const std::invalid_argument&) {
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cout << "\n  Tuning file test failed: " << e.what() << std::endl;
+        success = false;
+    }
+    fs::remove_all(tuningPath.parent_path());
+    return success;
+}
+
+bool test_frame_sequence_matches_full_recompute() {
+    // Test: Incremental updates equal a full recompute after every frame, recompute only
+    // changed tiles, and the dirty-rectangle variant agrees with the pixel diff
+    const int width = 61, height = 47, channels = 3;
+    std::vector<uint8_t> frame = makeNoiseImage(width, height, channels);
+    ImageView view{frame.data(), width, height, channels, static_cast<size_t>(width) * channels};
+    // Changed pixels: corners, tile boundaries (tiles are 8x8) and the partial last tile
+    const Rect changes[] = {{0, 0, 1, 1}, {7, 7, 2, 2}, {60, 46, 1, 1}, {23, 15, 1, 9}, {40, 0, 21, 3}};
+
+    bool success = true;
+    for (unsigned threads : {1u, 3u}) {
+        SequenceOptions options;
+        options.tileSize = 8;
+        options.detection.threads = threads;
+        FrameSequence sequence("Sobel", options);
+        FrameSequence rectSequence("Sobel", options);
+        FrameUpdate first = sequence.process(view);
+        rectSequence.process(view);
+        success = success && first.fullFrame && first.dirtyTiles == 8 * 6 && first.totalTiles == 8 * 6;
+
+        FrameUpdate unchanged = sequence.process(view);
+        success = success && !unchanged.fullFrame && unchanged.dirtyTiles == 0;
+
+        uint32_t seed = 7;
+        for (const Rect& change : changes) {
+            for (int y = change.y; y < change.y + change.height; ++y) {
+                for (int x = change.x; x < change.x + change.width; ++x) {
+                    seed = seed * 1664525u + 1013904223u;
+                    frame[(static_cast<size_t>(y) * width + x) * channels + seed % channels] ^= 0x5A;
+                }
+            }
+            Image expected = EdgeDetector::detectEdges(view, "Sobel");
+            FrameUpdate update = sequence.process(view);
+            FrameUpdate rectUpdate = rectSequence.process(view, {change});
+            auto edges = [](const FrameUpdate& u) {
+                return ByteSpan(u.edges.data, static_cast<size_t>(u.edges.width) * u.edges.height);
+            };
+            success = success && edges(update) == expected.getData() &&
+                      edges(rectUpdate) == edges(update) && update.dirtyTiles == rectUpdate.dirtyTiles &&
+                      update.dirtyTiles >= 1 && update.dirtyTiles < update.totalTiles;
+        }
+        success = success && sequence.process(view).dirtyTiles == 0;
+    }
+
+    // New geometry restarts the sequence; rectangles outside the frame are rejected
+    FrameSequence sequence("Prewitt");
+    sequence.process(view);
+    ImageView cropped{frame.data(), 30, 20, channels, view.stride};
+    FrameUpdate restarted = sequence.process(cropped);
+    success = success && restarted.fullFrame && restarted.edges.width == 30 &&
+              ByteSpan(restarted.edges.data, 30 * 20) == EdgeDetector::detectEdges(cropped, "Prewitt").getData();
+    try {
+        sequence.process(cropped, {Rect{25, 15, 10, 1}});
+        success = false;
+    } catch (const std::invalid_argument&) {
+    }
+    return success;
+}
+
+bool test_edge_detector_multi_operator_matches_separate_calls() {
+    // Test: One multi-operator pass equals separate detectEdges calls for every operator
+    // set, norm and kernel variant, including row tails, tiles and threads
+    std::string original = GradientKernels::active().name;
+    const std::vector<std::vector<std::string>> operatorSets = {
+        {"Sobel"}, {"Sobel", "Prewitt"}, {"scharr", "Sobel"}, {"Prewitt", "Scharr", "Sobel"}};
+    bool success = true;
+
+    for (int width : {5, 37, 70}) {
+        const int height = 13, channels = 3;
+        std::vector<uint8_t> pixels = makeNoiseImage(width, height, channels);
+        ImageView view{pixels.data(), width, height, channels, static_cast<size_t>(width) * channels};
+        for (const auto& variant : GradientKernels::available()) {
+            GradientKernels::select(variant.name);
+            for (GradientNorm norm : {GradientNorm::L2, GradientNorm::L1, GradientNorm::LInf}) {
+                EdgeDetectionOptions options;
+                options.norm = norm;
+                for (const auto& names : operatorSets) {
+                    std::vector<Image> results = EdgeDetector::detectEdgesMulti(view, names, options);
+                    success = success && results.size() == names.size();
+                    for (size_t i = 0; i < results.size() && success; ++i) {
+                        success = results[i].getData() == EdgeDetector::detectEdges(view, names[i], options).getData();
+                    }
+                }
+            }
+        }
+    }
+    GradientKernels::select(original);
+
+    // Tiles and threads split the work without changing the planes
+    const int width = 61, height = 29;
+    std::vector<uint8_t> gray = makeNoiseImage(width, height, 1);
+    ImageView view{gray.data(), width, height, 1, static_cast<size_t>(width)};
+    EdgeDetectionOptions split;
+    split.threads = 3;
+    split.tiles = TileSize{16, 8};
+    std::vector<Image> results = EdgeDetector::detectEdgesMulti(view, {"Scharr", "Prewitt"}, split);
+    success = success && results[0].getData() == EdgeDetector::detectEdges(view, "Scharr").getData() &&
+              results[1].getData() == EdgeDetector::detectEdges(view, "Prewitt").getData();
+
+    // Repeated or missing operators are rejected
+    for (const std::vector<std::string>& names : {std::vector<std::string>{"Sobel", "sobel"},
+                                                  std::vector<std::string>{}}) {
+        try {
+            EdgeDetector::detectEdgesMulti(view, names);
+            success = false;
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return success;
+}
+
+bool test_result_cache_hits_misses_and_lru_eviction() {
+    // Test: The hash matches XXH64 reference values, keys follow content and settings,
+    // hits reproduce the stored file, eviction drops the least recently used entry, and
+    // a repeated batch is served entirely from the cache
+    namespace fs = std::filesystem;
+    auto text = [](const std::string& value) {
+        return ByteSpan(reinterpret_cast<const uint8_t*>(value.data()), value.size());
+    };
+    bool success = ResultCache::hash(text("")) == 0xEF46DB3751D8E999ull &&
+                   ResultCache::hash(text("abc")) == 0x44BC2CF5AD770999ull &&
+                   ResultCache::hash(text("Nobody inspects the spammish repetition")) == 0xFBCEA83C8A378BF1ull;
+
+    // Pixel hashes ignore the row stride; keys change with content and settings
+    std::vector<uint8_t> pixels = makeNoiseImage(8, 6, 3);
+    std::vector<uint8_t> padded(10 * 3 * 6);
+    for (int y = 0; y < 6; ++y) {
+        std::copy_n(pixels.begin() + y * 24, 24, padded.begin() + y * 30);
+    }
+    uint64_t content = ResultCache::pixelHash(ImageView{pixels.data(), 8, 6, 3, 24});
+    success = success && content == ResultCache::pixelHash(ImageView{padded.data(), 8, 6, 3, 30});
+    pixels[5] ^= 1;
+    success = success && content != ResultCache::pixelHash(ImageView{pixels.data(), 8, 6, 3, 24}) &&
+              ResultCache::key(content, "operator=sobel") != ResultCache::key(content, "operator=prewitt") &&
+              ResultCache::key(content, "operator=sobel").size() == 16;
+
+    fs::path root = fs::temp_directory_path() / "edge_cache_test";
+    fs::remove_all(root);
+    fs::create_directories(root);
+    try {
+        auto writeFile = [&](const std::string& name, char fill) {
+            std::ofstream((root / name).string(), std::ios::binary) << std::string(1000, fill);
+            return (root / name).string();
+        };
+        auto contents = [](const fs::path& path) {
+            std::ifstream file(path.string(), std::ios::binary);
+            return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        };
+        auto pause = [] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); };
+
+        ResultCache cache((root / "entries").string(), 2500);
+        std::string fetched = (root / "fetched").string();
+        success = success && !cache.fetch("a", fetched);
+        cache.store("a", writeFile("result_a", 'a'));
+        pause();
+        cache.store("b", writeFile("result_b", 'b'));
+        pause();
+        success = success && cache.fetch("a", fetched) && contents(fetched) == std::string(1000, 'a');
+        pause();
+        cache.store("c", writeFile("result_c", 'c'));
+
+        // "b" was used least recently: storing "c" crossed the limit and evicted it
+        CacheStats stats = cache.stats();
+        success = success && !cache.fetch("b", fetched) && cache.fetch("c", fetched) && cache.fetch("a", fetched) &&
+                  stats.hits == 1 && stats.misses == 1 && stats.stores == 3 && stats.evictions == 1;
+
+        // Another process's store in flight is neither counted nor evicted; abandoned ones are removed
+        fs::path inFlight = root / "entries" / "d.tmp999999_0";
+        fs::path abandoned = root / "entries" / "e.tmp999999_1";
+        std::ofstream(inFlight.string(), std::ios::binary) << std::string(5000, 't');
+        std::ofstream(abandoned.string(), std::ios::binary) << std::string(10, 't');
+        fs::last_write_time(abandoned, fs::file_time_type::clock::now() - std::chrono::hours(2));
+        ResultCache shared((root / "entries").string(), 2500);
+        shared.store("f", writeFile("result_f", 'f'));
+        success = success && fs::exists(inFlight) && !fs::exists(abandoned) && shared.stats().evictions == 1;
+
+        // A repeated batch copies every result from the cache
+        fs::path inputDir = root / "inputs";
+        fs::create_directories(inputDir);
+        for (int i = 0; i < 3; ++i) {
+            Image(makeNoiseImage(8, 6, 3, i + 1), 8, 6, 3).saveToFile((inputDir / ("frame" + std::to_string(i) + ".png")).string());
+        }
+        ResultCache batchCache((root / "batch").string());
+        BatchOptions options;
+        options.outputDir = (root / "outputs").string();
+        options.cache = &batchCache;
+        std::vector<std::string> inputs = BatchProcessor::collectInputs(inputDir.string());
+        BatchResult first = BatchProcessor::run(inputs, options);
+        std::string expected = contents(root / "outputs" / "frame1_Sobel_edges.png");
+        fs::remove_all(root / "outputs");
+        BatchResult second = BatchProcessor::run(inputs, options);
+        stats = batchCache.stats();
+        success = success && first.succeeded == 3 && second.succeeded == 3 && stats.misses == 3 &&
+                  stats.hits == 3 && contents(root / "outputs" / "frame1_Sobel_edges.png") == expected;
+    } catch (const std::exception& e) {
+        std::cout << "\n  Result cache test failed: " << e.what() << std::endl;
+        success = false;
+    }
+    fs::remove_all(root);
+    return success;
+}
+
+bool test_edge_pipeline_fused_stages_match_sequential_evaluation() {
+    // Test: Fused per-tile pipelines equal running each stage on the whole image in turn,
+    // for any tile size and thread count
+    const int width = 53, height = 31, channels = 3;
+    std::vector<uint8_t> pixels = makeNoiseImage(width, height, channels);
+    ImageView view{pixels.data(), width, height, channels, static_cast<size_t>(width) * channels};
+    const std::vector<PipelineOptions> splits = {
+        {1, TileSize{0, 0}}, {1, TileSize{16, 8}}, {3, TileSize{7, 5}}, {0, TileSize{1, 1}}};
+
+    // Reference: whole-image stages with clamped borders
+    auto blurPlane = [&](const std::vector<uint8_t>& plane, BlurKernel kernel) {
+        std::vector<uint8_t> result(plane.size());
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int sum = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        int sx = std::min(std::max(x + dx, 0), width - 1);
+                        int sy = std::min(std::max(y + dy, 0), height - 1);
+                        int weight = kernel == BlurKernel::Box ? 1 : (2 - std::abs(dx)) * (2 - std::abs(dy));
+                        sum += weight * plane[sy * width + sx];
+                    }
+                }
+                result[y * width + x] = kernel == BlurKernel::Box ? (sum + 4) / 9 : (sum + 8) >> 4;
+            }
+        }
+        return result;
+    };
+    std::vector<uint8_t> gray(static_cast<size_t>(width) * height);
+    Image::convertToGrayscale(pixels.data(), gray.data(), width * height, channels, LumaWeights::BT709);
+
+    bool success = true;
+    for (BlurKernel kernel : {BlurKernel::Box, BlurKernel::Gaussian}) {
+        std::vector<uint8_t> blurred = blurPlane(blurPlane(gray, kernel), kernel);
+        Image edges = EdgeDetector::detectEdges(
+            ImageView{blurred.data(), width, height, 1, static_cast<size_t>(width)}, "Prewitt");
+        std::vector<uint8_t> expected(edges.getData().begin(), edges.getData().end());
+        for (uint8_t& value : expected) {
+            int stretched = std::min(std::max(static_cast<int>(value), 20), 220);
+            value = ((stretched - 20) * 255 + 100) / 200 >= 128 ? 255 : 0;
+        }
+
+        EdgePipeline pipeline;
+        pipeline.grayscale(LumaWeights::BT709).blur(kernel).blur(kernel)
+                .gradient(EdgeOperator::Prewitt).normalize(20, 220).threshold(128);
+        success = success && pipeline.halo() == 3;
+        for (const PipelineOptions& options : splits) {
+            success = success && pipeline.run(view, options).getData() == expected;
+        }
+    }
+
+    // A gradient-only pipeline is detectEdges, for every norm
+    for (GradientNorm norm : {GradientNorm::L2, GradientNorm::L1, GradientNorm::LInf}) {
+        EdgeDetectionOptions detection;
+        detection.norm = norm;
+        Image expected = EdgeDetector::detectEdges(view, "Sobel", detection);
+        EdgePipeline pipeline;
+        pipeline.gradient(EdgeOperator::Sobel, norm);
+        for (const PipelineOptions& options : splits) {
+            success = success && pipeline.run(view, options).getData() == expected.getData();
+        }
+    }
+
+    // A pipeline of only grayscale conversion, into strided output
+    std::vector<uint8_t> bt601(gray.size());
+    Image::convertToGrayscale(pixels.data(), bt601.data(), width * height, channels, LumaWeights::BT601);
+    std::vector<uint8_t> strided(static_cast<size_t>(width + 5) * height, 7);
+    EdgePipeline().runInto(view, strided.data(), width + 5, splits[2]);
+    for (int y = 0; y < height && success; ++y) {
+        success = std::equal(bt601.begin() + y * width, bt601.begin() + (y + 1) * width,
+                             strided.begin() + y * (width + 5)) && strided[y * (width + 5) + width] == 7;
+    }
+
+    // Invalid stages and inputs are rejected
+    auto throwsInvalidArgument = [](const std::function<void()>& call) {
+        try {
+            call();
+        } catch (const std::invalid_argument&) {
+            return true;
+        }
+        return false;
+    };
+    success = success && throwsInvalidArgument([] { EdgePipeline().threshold(256); }) &&
+              throwsInvalidArgument([] { EdgePipeline().normalize(50, 50); }) &&
+              throwsInvalidArgument([] { EdgePipeline().blur(BlurKernel::Box).grayscale(LumaWeights::BT601); }) &&
+              throwsInvalidArgument([&] { EdgePipeline().runInto(view, strided.data(), width - 1); });
+    try {
+        EdgePipeline().run(ImageView{pixels.data(), width, height, 2, static_cast<size_t>(width) * 2});
+        success = false;
+    } catch (const std::runtime_error&) {
+    }
+    return success;
+}
+
+bool test_edge_detector_steady_state_does_not_allocate() {
+    // Test: With a reused workspace and buffer pool, repeated frames make no heap allocations
+    const int width = 61, height = 47;
+    Image frame(makeNoiseImage(width, height, 3), width, height, 3);
+
+    for (unsigned threads : {1u, 3u}) {
+        EdgeDetectionOptions options;
+        options.threads = threads;
+        Image expected = EdgeDetector::detectEdges(frame, "Sobel", options);
+
+        EdgeDetector::Workspace workspace;
+        BufferPool pool(2);
+        std::vector<uint8_t> strided(static_cast<size_t>(width + 5) * height);
+
+        // Warm-up sizes the workspace, the pool and the shared thread pool
+        EdgeDetector::detectEdges(frame.view(), "Sobel", workspace, pool, options);
+        EdgeDetector::detectEdgesInto(frame.view(), "Sobel", strided.data(), width + 5, workspace, options);
+
+        size_t allocationsBefore = heapAllocations.load();
+        bool matches = true;
+        for (int i = 0; i < 5; ++i) {
+            Image result = EdgeDetector::detectEdges(frame.view(), "Sobel", workspace, pool, options);
+            matches = matches && result.getData() == expected.getData();
+            EdgeDetector::detectEdgesInto(frame.view(), "Sobel", strided.data(), width + 5, workspace, options);
+        }
+        size_t allocations = heapAllocations.load() - allocationsBefore;
+
+        for (int y = 0; y < height; ++y) {
+            matches = matches && std::equal(strided.begin() + y * (width + 5), strided.begin() + y * (width + 5) + width,
+                                            expected.getData().begin() + y * width);
+        }
+        if (!matches || allocations != 0 || pool.size() != 1) {
+            return false;
+        }
+    }
+
+    // An output narrower than the image is rejected
+    EdgeDetector::Workspace workspace;
+    std::vector<uint8_t> small(width * height);
+    try {
+        EdgeDetector::detectEdgesInto(frame.view(), "Sobel", small.data(), width - 1, workspace);
+        return false;
+    } catch (const std::invalid_argument&) {
+        return true;
+    }
+}
+
+bool test_profiler_records_stages_and_chrome_trace() {
+    // Test: Enabled profiling records each stage with its byte count and exports
+    // a Chrome trace; disabled profiling records nothing
+    int width = 32, height = 24;
+    Image color(makeNoiseImage(width, height, 3), width, height, 3);
+    std::string tracePath = "test_profile_trace.json";
+
+    Profiler::enable();
+    color.toGrayscale();
+    EdgeDetector::detectEdges(color, "Sobel");
+    EdgeDetectionOptions parallel;
+    parallel.threads = 2;
+    EdgeDetector::detectEdges(color, "Prewitt", parallel);
+    {
+        Profiler::WorkerSection section;
+        Profiler::Scope scope("worker_stage");
+    }
+    Profiler::enable(false);
+    std::vector<ProfileEvent> events = Profiler::events();
+    Profiler::writeChromeTrace(tracePath);
+
+    EdgeDetector::detectEdges(color, "Sobel");
+    bool disabledRecordsNothing = Profiler::events().size() == events.size();
+
+    size_t pixels = static_cast<size_t>(width) * height;
+    bool hasGrayscale = false, hasDetect = false;
+    for (const auto& event : events) {
+        hasGrayscale |= std::string(event.name) == "grayscale" && event.bytes == pixels * 4;
+        hasDetect |= std::string(event.name) == "detect" && event.bytes == pixels * 4 && event.durationNs >= 0;
+    }
+
+    // Memory is sampled for top-level stages only; pool tasks and worker sections skip it
+    bool memoryOnlyTopLevel = true, sawPoolBand = false;
+    for (const auto& event : events) {
+        std::string name = event.name;
+        if (name == "detect" || name == "grayscale") {
+            memoryOnlyTopLevel = memoryOnlyTopLevel && event.memorySampled;
+        }
+        if (name == "worker_stage") {
+            memoryOnlyTopLevel = memoryOnlyTopLevel && !event.memorySampled;
+        }
+        sawPoolBand |= name == "detect_band" && !event.memorySampled;
+        memoryOnlyTopLevel = memoryOnlyTopLevel &&
+                             (event.memorySampled || (event.heapDeltaBytes == 0 && event.peakGrowthBytes == 0));
+    }
+    memoryOnlyTopLevel = memoryOnlyTopLevel && sawPoolBand;
+
+    std::ifstream trace(tracePath);
+    std::string contents((std::istreambuf_iterator<char>(trace)), std::istreambuf_iterator<char>());
+    std::remove(tracePath.c_str());
+
+    return hasGrayscale && hasDetect && disabledRecordsNothing && memoryOnlyTopLevel &&
+           contents.find("\"traceEvents\"") != std::string::npos &&
+           contents.find("\"name\": \"detect\"") != std::string::npos &&
+           Profiler::summary().find("grayscale") != std::string::npos;
+}
+
+bool test_thread_pool_runs_every_index_and_propagates_errors() {
+    // Test: parallelFor visits each index exactly once and rethrows task exceptions
+    ThreadPool pool(4);
+    std::vector<int> visits(1000, 0);
+    pool.parallelFor(visits.size(), [&](size_t i) { visits[i]++; });
+    bool eachOnce = std::all_of(visits.begin(), visits.end(), [](int v) { return v == 1; });
+
+    // Shared pools are capped at the core count, so arbitrary counts cannot pile up pools
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool& all = ThreadPool::shared(0);
+    eachOnce = eachOnce && all.size() == cores && &ThreadPool::shared(cores + 1) == &all &&
+               &ThreadPool::shared(~0u) == &all && ThreadPool::shared(1).size() == 1;
+
+    try {
+        pool.parallelFor(10, [](size_t i) {
+            if (i == 7) throw std::runtime_error("task failed");
+        });
+        return false; // Should have thrown
+    } catch (const std::runtime_error&) {
+        return eachOnce; // Expected
+    }
+}
+
 // =============================================================================
 // INTEGRATION TESTS - FULL PIPELINE/WORKFLOW  
 // =============================================================================
@@ -392,6 +1625,202 @@ bool test_integration_both_operators_complete_workflow() {
 }
 
 
+bool test_integration_batch_directory_pipeline() {
+    // Test: Batch mode processes every image in a directory with per-input output names
+    namespace fs = std::filesystem;
+    fs::path inputDir = fs::temp_directory_path() / "edge_batch_test_input";
+    fs::path outputDir = fs::temp_directory_path() / "edge_batch_test_output";
+    fs::remove_all(inputDir);
+    fs::remove_all(outputDir);
+    fs::create_directories(inputDir);
+
+    try {
+        for (int i = 0; i < 3; ++i) {
+            Image(makeNoiseImage(8, 6, 3, i + 1), 8, 6, 3).saveToFile((inputDir / ("frame" + std::to_string(i) + ".png")).string());
+        }
+        std::ofstream((inputDir / "notes.txt").string()) << "not an image";
+
+        BatchOptions options;
+        options.operatorName = "Prewitt";
+        options.outputDir = outputDir.string();
+        options.decodeThreads = 2;
+        options.encodeThreads = 2;
+        options.queueCapacity = 1;
+
+        std::vector<std::string> inputs = BatchProcessor::collectInputs(inputDir.string());
+        BatchResult result = BatchProcessor::run(inputs, options);
+
+        bool success = inputs.size() == 3 && result.succeeded == 3 && result.errors.empty() &&
+                       fs::exists(outputDir / "frame0_Prewitt_edges.png") &&
+                       fs::exists(outputDir / "frame2_Prewitt_edges.png");
+
+        // Same-stem inputs from different folders must not overwrite each other
+        std::vector<std::string> outputs = BatchProcessor::outputPaths({"a/x.png", "b/x.jpg"}, "Sobel", "out");
+        success = success && outputs[0] != outputs[1];
+
+        // Suffixed names must not collide with inputs whose stem already has that suffix
+        outputs = BatchProcessor::outputPaths({"a/foo.png", "b/foo.png", "c/foo_1.png", "d/foo_1.png"}, "Sobel", "out");
+        success = success && std::set<std::string>(outputs.begin(), outputs.end()).size() == outputs.size() &&
+                  outputs[0] == (fs::path("out") / "foo_Sobel_edges.png").string() &&
+                  outputs[1] == (fs::path("out") / "foo_1_Sobel_edges.png").string();
+
+        fs::remove_all(inputDir);
+        fs::remove_all(outputDir);
+        return success;
+
+    } catch (const std::exception& e) {
+        std::cout << "\n  Batch pipeline test failed: " << e.what() << std::endl;
+        fs::remove_all(inputDir);
+        fs::remove_all(outputDir);
+        return false;
+    }
+}
+
+bool test_integration_streaming_matches_in_memory() {
+    // Test: Strip-wise streaming from a PPM file gives the in-memory result for any strip height
+    namespace fs = std::filesystem;
+    fs::path inputPath = fs::temp_directory_path() / "edge_stream_test.ppm";
+    fs::path outputPath = fs::temp_directory_path() / "edge_stream_test_out.pgm";
+    const int width = 23, height = 37;
+
+    try {
+        std::vector<uint8_t> pixels = makeNoiseImage(width, height, 3);
+        {
+            std::ofstream file(inputPath.string(), std::ios::binary);
+            file << "P6\n# streaming test\n" << width << " " << height << "\n255\n";
+            file.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+        }
+
+        bool success = true;
+        for (unsigned threads : {1u, 3u}) {
+            EdgeDetectionOptions options;
+            options.threads = threads;
+            Image expected = EdgeDetector::detectEdges(Image(pixels, width, height, 3), "Sobel", options);
+
+            for (int stripRows : {1, 4, 36, 64}) {
+                ScanlineReader reader = ScanlineReader::openPnm(inputPath.string());
+                ScanlineWriter writer(outputPath.string(), width, height, 1);
+                EdgeDetector::detectEdgesStreaming(reader, writer, "Sobel", options, stripRows);
+
+                std::ifstream result(outputPath.string(), std::ios::binary);
+                std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(result)), std::istreambuf_iterator<char>());
+                PnmHeader header = PnmIO::parseHeader(bytes.data(), bytes.size());
+                std::vector<uint8_t> streamed(bytes.begin() + header.dataOffset, bytes.end());
+
+                success = success && header.width == width && header.height == height &&
+                          header.channels == 1 && streamed == expected.getData();
+            }
+        }
+
+        fs::remove(inputPath);
+        fs::remove(outputPath);
+        return success;
+
+    } catch (const std::exception& e) {
+        std::cout << "\n  Streaming test failed: " << e.what() << std::endl;
+        fs::remove(inputPath);
+        fs::remove(outputPath);
+        return false;
+    }
+}
+
+// Minimal blocking client for the serve-mode protocol
+int connectToServer(const std::string& socketPath) {
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", socketPath.c_str());
+    if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(client);
+        return -1;
+    }
+    return client;
+}
+
+// Sends one request and returns the response line; the response payload goes to payload
+std::string serverRequest(int client, const std::string& line, const std::vector<uint8_t>& body,
+                          std::vector<uint8_t>& payload) {
+    std::string request = line + "\n";
+    request.append(body.begin(), body.end());
+    send(client, request.data(), request.size(), MSG_NOSIGNAL);
+
+    std::string response;
+    char c = 0;
+    while (recv(client, &c, 1, 0) == 1 && c != '\n') {
+        response += c;
+    }
+    size_t sizeAt = response.find(" size=");
+    payload.resize(sizeAt == std::string::npos ? 0 : std::stoul(response.substr(sizeAt + 6)));
+    for (size_t done = 0; done < payload.size();) {
+        ssize_t received = recv(client, payload.data() + done, payload.size() - done, 0);
+        if (received <= 0) {
+            break;
+        }
+        done += static_cast<size_t>(received);
+    }
+    return response;
+}
+
+bool test_integration_server_serves_concurrent_requests() {
+    // Test: The daemon answers inline and path requests with the library's results,
+    // reports errors without dropping the connection, and serves a second client
+    // while the first one stays connected
+    namespace fs = std::filesystem;
+    fs::path outputPath = fs::temp_directory_path() / "edge_server_test_out.pgm";
+    const int width = 21, height = 14;
+    std::vector<uint8_t> pixels = makeNoiseImage(width, height, 3);
+    std::string ppmHeader = PnmIO::formatHeader(width, height, 3);
+    std::vector<uint8_t> ppm(ppmHeader.begin(), ppmHeader.end());
+    ppm.insert(ppm.end(), pixels.begin(), pixels.end());
+    Image expected = EdgeDetector::detectEdges(Image(pixels, width, height, 3), "Scharr");
+
+    ServerOptions options;
+    options.socketPath = (fs::temp_directory_path() / ("edge_server_" + std::to_string(getpid()) + ".sock")).string();
+    options.workers = 2;
+    EdgeServer server(options);
+    std::thread serverThread([&server] { server.run(); });
+
+    int idle = connectToServer(options.socketPath);
+    int client = connectToServer(options.socketPath);
+    std::vector<uint8_t> payload;
+
+    std::string inlineResponse = serverRequest(client, "detect operator=Scharr input=- size=" +
+                                               std::to_string(ppm.size()) + " output=- format=raw", ppm, payload);
+    bool inlineMatches = inlineResponse.rfind("ok width=21 height=14 ", 0) == 0 && payload == expected.getData();
+
+    // Encoded payloads are decoded from memory; PNG results decode back to the same pixels
+    std::vector<uint8_t> png = PngEncoder::encode(ImageView{pixels.data(), width, height, 3, width * 3u});
+    std::string pngResponse = serverRequest(client, "detect operator=Scharr input=- size=" +
+                                            std::to_string(png.size()) + " output=-", png, payload);
+    inlineMatches = inlineMatches && pngResponse.rfind("ok width=21 height=14 ", 0) == 0 &&
+                    Image::loadFromMemory(payload).getData() == expected.getData();
+
+    std::string errorResponse = serverRequest(client, "detect operator=Unknown input=- size=" +
+                                              std::to_string(ppm.size()) + " output=-", ppm, payload);
+    bool errorReported = errorResponse.rfind("error Unknown edge detection operator", 0) == 0 && payload.empty();
+
+    // Thread counts are validated; multi-threaded requests share one pool with the same results
+    std::string threadsResponse = serverRequest(client, "detect operator=Scharr input=- threads=-1 size=" +
+                                                std::to_string(ppm.size()) + " output=-", ppm, payload);
+    errorReported = errorReported && threadsResponse.rfind("error Invalid threads: -1", 0) == 0 && payload.empty();
+    std::string parallelResponse = serverRequest(client, "detect operator=Scharr input=- threads=100000 size=" +
+                                                 std::to_string(ppm.size()) + " output=- format=raw", ppm, payload);
+    errorReported = errorReported && parallelResponse.rfind("ok ", 0) == 0 && payload == expected.getData();
+
+    std::string rawResponse = serverRequest(client, "detect operator=scharr input=- raw=21x14x3 size=" +
+                                            std::to_string(pixels.size()) + " output=" + outputPath.string(),
+                                            pixels, payload);
+    bool pathWritten = rawResponse.rfind("ok ", 0) == 0 && rawResponse.find("total_us=") != std::string::npos &&
+                       Image::loadFromFile(outputPath.string()).getData() == expected.getData();
+
+    server.stop();
+    serverThread.join();
+    close(idle);
+    close(client);
+    fs::remove(outputPath);
+    return idle >= 0 && inlineMatches && errorReported && pathWritten;
+}
+
 // =============================================================================
 // MAIN TEST RUNNER
 // =============================================================================
@@ -407,6 +1836,10 @@ int main() {
     runTest("Image Constructor with Valid Data", test_image_constructor_valid_data);
     runTest("Image Constructor with Invalid Dimensions", test_image_constructor_invalid_dimensions);
     runTest("Image Constructor with Data Size Mismatch", test_image_constructor_data_size_mismatch);
+    runTest("Image Adopts Buffer Without Copying", test_image_adopts_buffer_without_copying);
+    runTest("Image Mapped PNM And Raw Round Trip", test_image_mapped_pnm_and_raw_round_trip);
+    runTest("Image Fixed-Point Grayscale And Luma Load", test_image_fixed_point_grayscale_and_luma_load);
+    runTest("Image In-Memory Decode And Encode", test_image_in_memory_decode_and_encode);
     
     // File loading tests
     runTest("Image Load Nonexistent File", test_image_load_nonexistent_file);
@@ -415,6 +1848,7 @@ int main() {
     // File saving tests
     runTest("Image Save Empty Filepath", test_image_save_empty_filepath);
     runTest("Image Save Invalid Image Data", test_image_save_invalid_image_data);
+    runTest("Image Save PNG Options Round Trip", test_image_save_png_options_round_trip);
     
     // UNIT TESTS - EDGEDETECTOR CLASS
     std::cout << "\n--- EDGEDETECTOR CLASS UNIT TESTS ---" << std::endl;
@@ -425,12 +1859,33 @@ int main() {
     runTest("EdgeDetector RGB Conversion", test_edge_detector_rgb_conversion);
     runTest("EdgeDetector Different Operators Produce Different Results", test_edge_detector_different_operators_produce_different_results);
     runTest("EdgeDetector Uniform Image", test_edge_detector_uniform_image);
+    runTest("EdgeDetector Separable Matches Direct Convolution", test_edge_detector_separable_matches_direct_convolution);
+    runTest("EdgeDetector L1 and Linf Norms", test_edge_detector_l1_and_linf_norms);
+    runTest("EdgeDetector Scharr And Custom Operators", test_edge_detector_scharr_and_custom_operators);
+    runTest("EdgeDetector Canny Thin Edges And Hysteresis", test_edge_detector_canny_thin_edges_and_hysteresis);
+    runTest("GradientKernels SIMD Variants Match Scalar", test_gradient_kernels_variants_match_scalar);
+    runTest("EdgeDetector Gradient Planes And Orientation", test_edge_detector_gradient_planes_and_orientation);
+    runTest("EdgeDetector Regions Match Full Frame Crops", test_edge_detector_regions_match_full_frame_crops);
+    runTest("EdgeDetector Fused Color Path Matches Grayscale Input", test_edge_detector_fused_color_matches_grayscale_input);
+    runTest("EdgeDetector Strided View Matches Cropped Image", test_edge_detector_strided_view_matches_cropped_image);
+    runTest("EdgeDetector Parallel Matches Serial", test_edge_detector_parallel_matches_serial);
+    runTest("EdgeDetector Tiled Matches Untiled And Tuning File", test_edge_detector_tiled_matches_untiled_and_tuning_file);
+    runTest("FrameSequence Matches Full Recompute", test_frame_sequence_matches_full_recompute);
+    runTest("EdgeDetector Multi-Operator Matches Separate Calls", test_edge_detector_multi_operator_matches_separate_calls);
+    runTest("ResultCache Hits, Misses And LRU Eviction", test_result_cache_hits_misses_and_lru_eviction);
+    runTest("EdgePipeline Fused Stages Match Sequential Evaluation", test_edge_pipeline_fused_stages_match_sequential_evaluation);
+    runTest("EdgeDetector Steady State Does Not Allocate", test_edge_detector_steady_state_does_not_allocate);
+    runTest("Profiler Records Stages And Chrome Trace", test_profiler_records_stages_and_chrome_trace);
+    runTest("ThreadPool Runs Every Index and Propagates Errors", test_thread_pool_runs_every_index_and_propagates_errors);
     
     // INTEGRATION TESTS - COMPLETE WORKFLOWS
     std::cout << "\n--- INTEGRATION TESTS (FULL PIPELINE) ---" << std::endl;
     runTest("Integration: Create→Process→Save→Load Pipeline", test_integration_create_process_save_pipeline);
     runTest("Integration: RGB→Grayscale→EdgeDetect Pipeline", test_integration_rgb_to_grayscale_pipeline);
     runTest("Integration: Both Operators Complete Workflow", test_integration_both_operators_complete_workflow);
+    runTest("Integration: Batch Directory Pipeline", test_integration_batch_directory_pipeline);
+    runTest("Integration: Streaming Matches In-Memory", test_integration_streaming_matches_in_memory);
+    runTest("Integration: Server Serves Concurrent Requests", test_integration_server_serves_concurrent_requests);
     
     std::cout << "\n Tests completed!" << std::endl;
     std::cout << "Assignment requirements tested:" << std::endl;